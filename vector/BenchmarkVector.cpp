@@ -0,0 +1,458 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include <iterator>
+#include <numeric>
+#include <random>
+#include <string>
+#include "JaggedVector.h"
+#include "PackedVector.h"
+#include "Vector.h"
+#include "VectorBufferPool.h"
+#include "VectorHash.h"
+#include "VectorParallel.h"
+#include "VectorPerfCounters.h"
+#include "VectorReclaimer.h"
+#include "VectorSort.h"
+#include "TestObject.h"
+
+///////////////////////////////////////////////////////////////////////////////
+/// MeasureMilliseconds
+///
+/// Runs the given callable once and returns the elapsed wall time.
+///
+template <typename Function>
+double MeasureMilliseconds(Function&& function)
+{
+	const auto start = std::chrono::steady_clock::now();
+	function();
+	const auto stop = std::chrono::steady_clock::now();
+
+	return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+TEST(InsertBenchmarks, GivenTestObjectVector_MiddleInsertCostIsProportionalToTheShiftedElements)
+{
+	const int elementCount = 2000;
+	Vector<TestObject> toVector;
+	toVector.reserve(elementCount * 2);
+
+	for (int i = 0; i < elementCount; ++i)
+	{
+		toVector.emplace_back(i);
+	}
+
+	TestObject::Reset();
+
+	const int insertCount = 500;
+	const double elapsed = MeasureMilliseconds([&toVector]()
+	{
+		for (int i = 0; i < insertCount; ++i)
+		{
+			toVector.insert(toVector.end() - 10, TestObject(i));
+		}
+	});
+
+	const int64_t copies = TestObject::sTOCopyCtorCount + TestObject::sTOCopyAssignCount;
+	std::printf("[ BENCH    ] %d middle inserts into Vector<TestObject>(%d): %.3f ms, %lld copies\n",
+		insertCount, elementCount, elapsed, static_cast<long long>(copies));
+
+	// Each insert shifts ten elements; a snapshot of the whole container would add thousands of copies per insert.
+	EXPECT_LE(copies, insertCount * 12);
+}
+
+TEST(TraversalBenchmarks, GivenAdjacencyLists_JaggedVectorTraversalMatchesNestedVector)
+{
+	const int rowCount = 500000;
+	const int edgeCount = rowCount * 8;
+	std::mt19937 random(7);
+	std::uniform_int_distribution<int> vertex(0, rowCount - 1);
+
+	// Edges arrive in random order, as when an adjacency list is built from an
+	// edge list, so the rows of the nested form end up scattered over the heap.
+	Vector<Vector<int>> nested(rowCount);
+
+	for (int i = 0; i < edgeCount; ++i)
+	{
+		nested[vertex(random)].push_back(vertex(random));
+	}
+
+	JaggedVector<int> jagged;
+	const double buildElapsed = MeasureMilliseconds([&]()
+	{
+		jagged = JaggedVector<int>::from_nested(nested);
+	});
+
+	long long nestedSum = 0;
+	const double nestedElapsed = MeasureMilliseconds([&]()
+	{
+		for (const Vector<int>& row : nested)
+		{
+			for (int value : row)
+			{
+				nestedSum += value;
+			}
+		}
+	});
+
+	long long jaggedSum = 0;
+	const double jaggedElapsed = MeasureMilliseconds([&]()
+	{
+		for (std::size_t i = 0; i < jagged.row_count(); ++i)
+		{
+			for (int value : jagged.row(i))
+			{
+				jaggedSum += value;
+			}
+		}
+	});
+
+	std::printf("[ BENCH    ] traversal of %d rows, %d values: Vector<Vector<int>> %.3f ms, JaggedVector<int> %.3f ms (built in %.3f ms)\n",
+		rowCount, edgeCount, nestedElapsed, jaggedElapsed, buildElapsed);
+
+	EXPECT_EQ(nestedSum, jaggedSum);
+	EXPECT_EQ(jagged.row_count(), nested.size());
+}
+
+TEST(SortBenchmarks, GivenRandomUint32Vector_RadixSortMatchesStdSort)
+{
+	const std::size_t count = 1 << 22;
+	std::mt19937 random(11);
+	Vector<std::uint32_t> values;
+	values.reserve(count);
+
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		values.push_back(random());
+	}
+
+	Vector<std::uint32_t> expected(values);
+
+	const double stdElapsed = MeasureMilliseconds([&expected]()
+	{
+		std::sort(expected.begin(), expected.end());
+	});
+
+	const double radixElapsed = MeasureMilliseconds([&values]()
+	{
+		parallel_sort(values);
+	});
+
+	std::printf("[ BENCH    ] sorting %zu uint32_t: std::sort %.3f ms, parallel_sort() %.3f ms on %zu threads\n",
+		count, stdElapsed, radixElapsed, VectorSort::thread_count(count));
+
+	EXPECT_TRUE(values == expected);
+}
+
+TEST(BufferPoolBenchmarks, GivenShortLivedVectors_PoolServesMostAllocations)
+{
+	const int iterations = 200000;
+
+	auto churn = []()
+	{
+		long long total = 0;
+
+		for (int i = 0; i < iterations; ++i)
+		{
+			Vector<int> tokens;
+
+			for (int j = 0; j < 1 + i % 40; ++j)
+			{
+				tokens.push_back(j);
+			}
+
+			total += tokens.size();
+		}
+
+		return total;
+	};
+
+	long long withoutPool = 0;
+	const double withoutPoolElapsed = MeasureMilliseconds([&]()
+	{
+		withoutPool = churn();
+	});
+
+	VectorBufferPool::reset_stats();
+	VectorBufferPool::enable();
+
+	long long withPool = 0;
+	const double withPoolElapsed = MeasureMilliseconds([&]()
+	{
+		withPool = churn();
+	});
+
+	const VectorBufferPool::statistics stats = VectorBufferPool::stats();
+	VectorBufferPool::enable(false);
+	VectorBufferPool::trim();
+
+	std::printf("[ BENCH    ] %d short-lived Vector<int>: %.3f ms without pool, %.3f ms with pool (%zu hits, %zu misses)\n",
+		iterations, withoutPoolElapsed, withPoolElapsed, stats.hits, stats.misses);
+
+	EXPECT_EQ(withoutPool, withPool);
+	EXPECT_GT(stats.hits, stats.misses * 100);
+}
+
+TEST(PackedScanBenchmarks, GivenSortedTimestamps_PackedScanMatchesVectorScan)
+{
+	const std::size_t count = 1 << 23;
+	std::mt19937 random(13);
+	Vector<std::uint64_t> values;
+	PackedVector<std::uint64_t> packed(PackedEncoding::Delta);
+	values.reserve(count);
+
+	std::uint64_t timestamp = 1'700'000'000'000;
+
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		timestamp += 10 + random() % 8;
+		values.push_back(timestamp);
+		packed.push_back(timestamp);
+	}
+
+	std::uint64_t vectorSum = 0;
+	const double vectorElapsed = MeasureMilliseconds([&]()
+	{
+		for (const std::uint64_t value : values)
+		{
+			vectorSum += value;
+		}
+	});
+
+	std::uint64_t packedSum = 0;
+	const double packedElapsed = MeasureMilliseconds([&]()
+	{
+		packed.for_each([&packedSum](std::uint64_t value)
+		{
+			packedSum += value;
+		});
+	});
+
+	const double vectorBytes = static_cast<double>(values.size() * sizeof(std::uint64_t));
+
+	std::printf("[ BENCH    ] scanning %zu uint64_t: Vector %.3f ms, PackedVector %.3f ms; %.1fx smaller\n",
+		count, vectorElapsed, packedElapsed, vectorBytes / static_cast<double>(packed.memory_bytes()));
+
+	EXPECT_EQ(vectorSum, packedSum);
+	EXPECT_LT(packed.memory_bytes() * 4, values.size() * sizeof(std::uint64_t));
+}
+
+TEST(HashBenchmarks, GivenLargeByteKey_BlockHashOutrunsElementwiseHash)
+{
+	const std::size_t count = 1 << 26;
+	std::mt19937 random(17);
+	Vector<std::uint8_t> bytes;
+	bytes.reserve(count);
+
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		bytes.push_back(static_cast<std::uint8_t>(random()));
+	}
+
+	std::size_t blockHash = 0;
+	const double blockElapsed = MeasureMilliseconds([&]()
+	{
+		blockHash = std::hash<Vector<std::uint8_t>>()(bytes);
+	});
+
+	std::uint64_t elementHash = 0;
+	const double elementElapsed = MeasureMilliseconds([&]()
+	{
+		for (const std::uint8_t byte : bytes)
+		{
+			elementHash = VectorHash::combine(elementHash, std::hash<std::uint8_t>()(byte));
+		}
+	});
+
+	const double gigabytes = static_cast<double>(count) / (1 << 30);
+
+	std::printf("[ BENCH    ] hashing %zu bytes: block hash %.3f ms (%.2f GB/s), per-element combine %.3f ms (%.2f GB/s)\n",
+		count, blockElapsed, gigabytes / (blockElapsed / 1000), elementElapsed, gigabytes / (elementElapsed / 1000));
+
+	EXPECT_EQ(blockHash, std::hash<Vector<std::uint8_t>>()(bytes));
+	EXPECT_NE(elementHash, 0u);
+}
+
+// 64 MB is enough to show the stall without thrashing a CI machine; the
+// threshold is lowered to match, since the default only defers larger buffers.
+TEST(ReclaimerBenchmarks, GivenHugeBuffer_DeferredFreeShortensTheReleasingThreadsStall)
+{
+	const std::size_t count = std::size_t(1) << 23;
+
+	auto release = [count]()
+	{
+		Vector<std::uint64_t> huge(count);
+		huge[count - 1] = 1;
+
+		return MeasureMilliseconds([&huge]()
+		{
+			huge = Vector<std::uint64_t>();
+		});
+	};
+
+	const double inlineElapsed = release();
+
+	VectorReclaimer::enable(count * sizeof(std::uint64_t) / 2);
+	const double deferredElapsed = release();
+	const double flushElapsed = MeasureMilliseconds([]()
+	{
+		VectorReclaimer::flush();
+	});
+	const VectorReclaimer::statistics stats = VectorReclaimer::stats();
+	VectorReclaimer::disable();
+
+	std::printf("[ BENCH    ] releasing a %zu MB Vector: inline %.3f ms, deferred %.3f ms (background free took up to %.3f ms)\n",
+		count * sizeof(std::uint64_t) >> 20, inlineElapsed, deferredElapsed, flushElapsed);
+
+	EXPECT_GE(stats.deferred, 1);
+	EXPECT_EQ(stats.queuedBuffers, 0);
+}
+
+TEST(ParallelBenchmarks, GivenLargeVector_ParallelScanAndCopyIfMatchSerial)
+{
+	const std::size_t count = std::size_t(1) << 24;
+	std::mt19937 random(19);
+	Vector<std::uint32_t> values;
+	values.reserve(count);
+
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		values.push_back(random() % 1000);
+	}
+
+	Vector<std::uint32_t> serialScan(values);
+	const double serialScanElapsed = MeasureMilliseconds([&serialScan]()
+	{
+		std::partial_sum(serialScan.begin(), serialScan.end(), serialScan.begin());
+	});
+
+	Vector<std::uint32_t> parallelScan;
+	const double parallelScanElapsed = MeasureMilliseconds([&]()
+	{
+		parallelScan = parallel_inclusive_scan(values);
+	});
+
+	auto small = [](std::uint32_t value) { return value < 100; };
+
+	Vector<std::uint32_t> serialCopy;
+	const double serialCopyElapsed = MeasureMilliseconds([&]()
+	{
+		std::copy_if(values.begin(), values.end(), std::back_inserter(serialCopy), small);
+	});
+
+	Vector<std::uint32_t> parallelCopy;
+	const double parallelCopyElapsed = MeasureMilliseconds([&]()
+	{
+		parallelCopy = parallel_copy_if(values, small);
+	});
+
+	std::printf("[ BENCH    ] %zu uint32_t on %zu threads: scan serial %.3f ms, parallel %.3f ms; copy_if serial %.3f ms, parallel %.3f ms\n",
+		count, VectorThreadPool::instance().thread_count(), serialScanElapsed, parallelScanElapsed, serialCopyElapsed, parallelCopyElapsed);
+
+	EXPECT_TRUE(parallelScan == serialScan);
+	EXPECT_TRUE(parallelCopy == serialCopy);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// ReportVectorCounters
+///
+/// Runs growth, front insert, front erase, iteration and copy on a Vector<T>
+/// under the hardware counters and prints one line per operation with the
+/// counts per element, so that a slow operation can be told apart as
+/// instruction-bound, miss-bound or mispredict-bound.
+///
+template <typename T, typename Make, typename Key>
+void ReportVectorCounters(VectorPerfCounters& counters, const char* typeName, Make make, Key key)
+{
+	const std::size_t count = 1 << 16;
+	const std::size_t shiftCount = 1 << 12;    // front inserts and erases shift every element
+
+	auto report = [&counters, typeName](const char* operation, std::size_t elements, const VectorPerfCounters::reading& counts)
+	{
+		std::printf("[ PERF     ] %-22s %-10s", typeName, operation);
+
+		for (int i = 0; i < VectorPerfCounters::kEventCount; ++i)
+		{
+			if (counts.valid[i])
+			{
+				std::printf("  %s/elem %9.3f", VectorPerfCounters::name(static_cast<VectorPerfCounters::event>(i)), counts.values[i] / elements);
+			}
+			else
+			{
+				std::printf("  %s/elem %9s", VectorPerfCounters::name(static_cast<VectorPerfCounters::event>(i)), "-");
+			}
+		}
+
+		if (counts.valid[VectorPerfCounters::kCycles] && counts.valid[VectorPerfCounters::kInstructions] && counts.values[VectorPerfCounters::kCycles] > 0)
+		{
+			std::printf("  IPC %.2f", counts.values[VectorPerfCounters::kInstructions] / counts.values[VectorPerfCounters::kCycles]);
+		}
+
+		std::printf("\n");
+	};
+
+	Vector<T> grown;
+	report("growth", count, counters.measure([&]()
+	{
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			grown.push_back(make(i));
+		}
+	}));
+
+	std::size_t checksum = 0;
+	report("iteration", count, counters.measure([&]()
+	{
+		for (const T& element : grown)
+		{
+			checksum += key(element);
+		}
+	}));
+
+	report("copy", count, counters.measure([&]()
+	{
+		Vector<T> copy(grown);
+		checksum += copy.size();
+	}));
+
+	Vector<T> shifted;
+	report("insert", shiftCount, counters.measure([&]()
+	{
+		for (std::size_t i = 0; i < shiftCount; ++i)
+		{
+			shifted.insert(shifted.begin(), make(i));
+		}
+	}));
+
+	report("erase", shiftCount, counters.measure([&]()
+	{
+		while (!shifted.empty())
+		{
+			shifted.erase(shifted.begin());
+		}
+	}));
+
+	EXPECT_GT(checksum, 0u);
+}
+
+TEST(PerfCounterBenchmarks, GivenVectorOperations_HardwareCountersAreReportedPerOperationAndType)
+{
+	VectorPerfCounters counters;
+
+	if (!counters.available())
+	{
+		GTEST_SKIP() << "hardware performance counters are not available (no PMU, not Linux, or perf_event_paranoid forbids them)";
+	}
+
+	ReportVectorCounters<int>(counters, "Vector<int>",
+		[](std::size_t i) { return static_cast<int>(i); },
+		[](int value) { return static_cast<std::size_t>(value) + 1; });
+
+	ReportVectorCounters<std::string>(counters, "Vector<std::string>",
+		[](std::size_t i) { return std::string(32, static_cast<char>('a' + i % 26)); },
+		[](const std::string& value) { return value.size(); });
+
+	ReportVectorCounters<TestObject>(counters, "Vector<TestObject>",
+		[](std::size_t i) { return TestObject(static_cast<int>(i)); },
+		[](const TestObject& value) { return static_cast<std::size_t>(value.mX) + 1; });
+}
@@ -0,0 +1,640 @@
+#pragma once
+
+#include <atomic>
+#include <utility>
+#include "Vector.h"
+
+///////////////////////////////////////////////////////////////////////////////
+/// CowVector
+///
+/// Copy-on-write flavour of Vector. Copies share one reference-counted
+/// buffer and are O(1); the first mutating call on a shared instance
+/// (push_back, insert, erase, non-const operator[], data(), begin(), ...)
+/// deep copies the elements so that the other owners are left untouched.
+///
+/// The reference count is atomic, so copies may be handed to other threads
+/// and released there. As with Vector, a single CowVector instance must not
+/// be mutated concurrently from several threads.
+///
+/// Reads through a non-const CowVector go through the mutating overloads;
+/// use std::as_const or the c* accessors to read without unsharing.
+///
+/// Handing out a mutable reference, pointer or iterator (operator[], at,
+/// begin, end, front, back, data, emplace_back, insert, erase) marks the
+/// buffer unshareable: later copies of this CowVector deep copy the elements,
+/// so a write through such a reference never shows up in a copy. The mark
+/// is cleared when the buffer is reallocated (push_back, reserve), since
+/// that invalidates every reference handed out, and a buffer the CowVector
+/// gets anew (a copy, an assignment, unshare()) starts unmarked. On an empty
+/// CowVector begin(), end() and data() neither allocate nor unshare, since
+/// there is nothing to write.
+///
+/// edit() gives scoped mutable access instead: the buffer is unshareable
+/// only while the returned editor lives, and references taken through it
+/// must not outlive it.
+///
+///    {
+///        CowVector<int>::editor values = v.edit();
+///        (*values)[0] = 1;
+///    }
+///    CowVector<int> copy(v);   // shares the buffer again
+///
+template<typename T>
+class CowVector
+{
+public:
+	class editor;
+
+	typedef typename Vector<T>::size_type       size_type;
+	typedef typename Vector<T>::difference_type difference_type;
+
+	typedef typename Vector<T>::value_type      value_type;
+
+	typedef typename Vector<T>::iterator        iterator;
+	typedef typename Vector<T>::const_iterator  const_iterator;
+
+	typedef typename Vector<T>::reference       reference;
+	typedef typename Vector<T>::const_reference const_reference;
+
+	typedef typename Vector<T>::pointer         pointer;
+	typedef typename Vector<T>::const_pointer   const_pointer;
+
+public:
+	CowVector() noexcept;
+	explicit CowVector(size_type count);
+	explicit CowVector(const Vector<T>& elements);
+	explicit CowVector(Vector<T>&& elements);
+	CowVector(std::initializer_list<T> ilist);
+	CowVector(const CowVector<T>& other);
+	CowVector(CowVector<T>&& other) noexcept;
+	~CowVector();
+	CowVector<T>& operator=(const CowVector<T>& other);
+	CowVector<T>& operator=(CowVector<T>&& other) noexcept;
+
+public:
+	template<class... Args>
+	reference emplace_back(Args&& ... args);
+
+	void push_back(const T& element);
+	void push_back(T&& element);
+
+	iterator insert(const_iterator pos, const T& value);
+	iterator insert(const_iterator pos, T&& value);
+
+	iterator erase(const_iterator pos);
+	iterator erase(const_iterator first, const_iterator last);
+
+	reference operator[](const size_type n);
+	const_reference operator[](const size_type n) const noexcept;
+
+	reference at(const size_type n);
+	const_reference at(const size_type n) const;
+
+public:
+	bool empty() const noexcept;
+	size_type size() const noexcept;
+	size_type capacity() const noexcept;
+	void reserve(const size_type newCapacity);
+
+	bool shared() const noexcept;
+	size_type use_count() const noexcept;
+	void unshare();
+
+	editor edit();
+
+public:
+	iterator                   begin();
+	const_iterator             begin() const noexcept;
+	const_iterator             cbegin() const noexcept;
+
+	iterator                   end();
+	const_iterator             end() const noexcept;
+	const_iterator             cend() const noexcept;
+
+	reference                  front();
+	const_reference            front() const;
+
+	reference                  back();
+	const_reference            back() const;
+
+	pointer                    data();
+	const_pointer              data() const noexcept;
+
+private:
+	struct SharedBuffer
+	{
+		template<class... Args>
+		explicit SharedBuffer(Args&& ... args)
+			:
+			refCount(1),
+			unshareable(false),
+			elements(std::forward<Args>(args)...)
+		{
+		}
+
+		std::atomic<size_type> refCount;
+		bool unshareable;
+		Vector<T> elements;
+	};
+
+	Vector<T>& mutable_elements();
+	Vector<T>& leaked_elements();
+	void forget_leaks_if_reallocated(const_pointer previous) noexcept;
+	static SharedBuffer* share(SharedBuffer* buffer);
+	void release() noexcept;
+
+private:
+	SharedBuffer* _buffer;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+/// CowVector::editor
+///
+/// Scoped mutable access to the elements of a CowVector, returned by edit().
+/// The CowVector holds its buffer alone and copies of it deep copy while the
+/// editor lives; afterwards it shares its buffer again, unless a reference
+/// handed out before edit() still marks it. The CowVector must not be
+/// assigned to while an editor for it is alive.
+///
+template<typename T>
+class CowVector<T>::editor
+{
+public:
+	explicit editor(CowVector<T>& owner);
+	editor(const editor&) = delete;
+	editor& operator=(const editor&) = delete;
+	~editor();
+
+	Vector<T>& operator*() const noexcept;
+	Vector<T>* operator->() const noexcept;
+
+private:
+	CowVector<T>* _owner;
+	bool _wasUnshareable;
+};
+
+template<typename T>
+CowVector<T>::editor::editor(CowVector<T>& owner)
+	:
+	_owner(&owner),
+	_wasUnshareable(false)
+{
+	owner.mutable_elements();
+	_wasUnshareable = std::exchange(owner._buffer->unshareable, true);
+}
+
+template<typename T>
+CowVector<T>::editor::~editor()
+{
+	if (_owner->_buffer)
+	{
+		_owner->_buffer->unshareable = _wasUnshareable;
+	}
+}
+
+template<typename T>
+inline Vector<T>& CowVector<T>::editor::operator*() const noexcept
+{
+	return _owner->_buffer->elements;
+}
+
+template<typename T>
+inline Vector<T>* CowVector<T>::editor::operator->() const noexcept
+{
+	return &_owner->_buffer->elements;
+}
+
+template<typename T>
+CowVector<T>::CowVector() noexcept
+	:
+	_buffer(nullptr)
+{
+}
+
+template<typename T>
+CowVector<T>::CowVector(size_type count)
+	:
+	_buffer(new SharedBuffer(count))
+{
+}
+
+template<typename T>
+CowVector<T>::CowVector(const Vector<T>& elements)
+	:
+	_buffer(new SharedBuffer(elements))
+{
+}
+
+template<typename T>
+CowVector<T>::CowVector(Vector<T>&& elements)
+	:
+	_buffer(new SharedBuffer(std::move(elements)))
+{
+}
+
+template<typename T>
+CowVector<T>::CowVector(std::initializer_list<T> ilist)
+	:
+	_buffer(new SharedBuffer(ilist))
+{
+}
+
+template<typename T>
+CowVector<T>::CowVector(const CowVector<T>& other)
+	:
+	_buffer(share(other._buffer))
+{
+}
+
+template<typename T>
+CowVector<T>::CowVector(CowVector<T>&& other) noexcept
+	:
+	_buffer(other._buffer)
+{
+	other._buffer = nullptr;
+}
+
+template<typename T>
+CowVector<T>::~CowVector()
+{
+	release();
+}
+
+template<typename T>
+CowVector<T>& CowVector<T>::operator=(const CowVector<T>& other)
+{
+	if (this == &other)
+	{
+		return *this;
+	}
+
+	SharedBuffer* buffer = share(other._buffer);
+	release();
+	_buffer = buffer;
+
+	return *this;
+}
+
+template<typename T>
+CowVector<T>& CowVector<T>::operator=(CowVector<T>&& other) noexcept
+{
+	std::swap(_buffer, other._buffer);
+
+	return *this;
+}
+
+template<typename T>
+template<class... Args>
+typename CowVector<T>::reference
+CowVector<T>::emplace_back(Args&& ... args)
+{
+	return leaked_elements().emplace_back(std::forward<Args>(args)...);
+}
+
+template<typename T>
+void CowVector<T>::push_back(const T& element)
+{
+	Vector<T>& elements = mutable_elements();
+	const_pointer previous = elements.data();
+
+	elements.push_back(element);
+	forget_leaks_if_reallocated(previous);
+}
+
+template<typename T>
+void CowVector<T>::push_back(T&& element)
+{
+	Vector<T>& elements = mutable_elements();
+	const_pointer previous = elements.data();
+
+	elements.push_back(std::move(element));
+	forget_leaks_if_reallocated(previous);
+}
+
+template<typename T>
+typename CowVector<T>::iterator
+CowVector<T>::insert(const_iterator pos, const T& value)
+{
+	const difference_type index = std::distance(cbegin(), pos);
+	Vector<T>& elements = leaked_elements();
+
+	return elements.insert(elements.begin() + index, value);
+}
+
+template<typename T>
+typename CowVector<T>::iterator
+CowVector<T>::insert(const_iterator pos, T&& value)
+{
+	const difference_type index = std::distance(cbegin(), pos);
+	Vector<T>& elements = leaked_elements();
+
+	return elements.insert(elements.begin() + index, std::move(value));
+}
+
+template<typename T>
+typename CowVector<T>::iterator
+CowVector<T>::erase(const_iterator pos)
+{
+	const difference_type index = std::distance(cbegin(), pos);
+	Vector<T>& elements = leaked_elements();
+
+	return elements.erase(elements.begin() + index);
+}
+
+template<typename T>
+typename CowVector<T>::iterator
+CowVector<T>::erase(const_iterator first, const_iterator last)
+{
+	const difference_type firstIndex = std::distance(cbegin(), first);
+	const difference_type lastIndex = std::distance(cbegin(), last);
+	Vector<T>& elements = leaked_elements();
+
+	return elements.erase(elements.begin() + firstIndex, elements.begin() + lastIndex);
+}
+
+template<typename T>
+typename CowVector<T>::reference
+CowVector<T>::operator[](const size_type n)
+{
+	return leaked_elements()[n];
+}
+
+template<typename T>
+typename CowVector<T>::const_reference
+CowVector<T>::operator[](const size_type n) const noexcept
+{
+	return _buffer->elements[n];
+}
+
+template<typename T>
+typename CowVector<T>::reference
+CowVector<T>::at(const size_type n)
+{
+	if (n >= size())
+	{
+		VectorErrorPolicy::raise(VectorError::OutOfRange, "CowVector::at -- out of range");
+	}
+
+	return leaked_elements()[n];
+}
+
+template<typename T>
+typename CowVector<T>::const_reference
+CowVector<T>::at(const size_type n) const
+{
+	if (n >= size())
+	{
+		VectorErrorPolicy::raise(VectorError::OutOfRange, "CowVector::at -- out of range");
+	}
+
+	return _buffer->elements[n];
+}
+
+template<typename T>
+inline bool CowVector<T>::empty() const noexcept
+{
+	return size() == 0;
+}
+
+template<typename T>
+inline typename CowVector<T>::size_type
+CowVector<T>::size() const noexcept
+{
+	return _buffer ? _buffer->elements.size() : 0;
+}
+
+template<typename T>
+inline typename CowVector<T>::size_type
+CowVector<T>::capacity() const noexcept
+{
+	return _buffer ? _buffer->elements.capacity() : 0;
+}
+
+template<typename T>
+void CowVector<T>::reserve(const size_type newCapacity)
+{
+	if (newCapacity <= capacity())
+	{
+		return;
+	}
+
+	Vector<T>& elements = mutable_elements();
+	const_pointer previous = elements.data();
+
+	elements.reserve(newCapacity);
+	forget_leaks_if_reallocated(previous);
+}
+
+template<typename T>
+inline bool CowVector<T>::shared() const noexcept
+{
+	return use_count() > 1;
+}
+
+template<typename T>
+inline typename CowVector<T>::size_type
+CowVector<T>::use_count() const noexcept
+{
+	return _buffer ? _buffer->refCount.load(std::memory_order_acquire) : 0;
+}
+
+template<typename T>
+void CowVector<T>::unshare()
+{
+	if (!shared())
+	{
+		return;
+	}
+
+	SharedBuffer* copy = new SharedBuffer(std::as_const(_buffer->elements));
+	release();
+	_buffer = copy;
+}
+
+template<typename T>
+inline typename CowVector<T>::editor
+CowVector<T>::edit()
+{
+	return editor(*this);
+}
+
+template<typename T>
+inline typename CowVector<T>::iterator
+CowVector<T>::begin()
+{
+	if (empty())
+	{
+		return const_cast<iterator>(std::as_const(*this).begin());
+	}
+
+	return leaked_elements().begin();
+}
+
+template<typename T>
+inline typename CowVector<T>::const_iterator
+CowVector<T>::begin() const noexcept
+{
+	return _buffer ? _buffer->elements.begin() : nullptr;
+}
+
+template<typename T>
+inline typename CowVector<T>::const_iterator
+CowVector<T>::cbegin() const noexcept
+{
+	return begin();
+}
+
+template<typename T>
+inline typename CowVector<T>::iterator
+CowVector<T>::end()
+{
+	if (empty())
+	{
+		return const_cast<iterator>(std::as_const(*this).end());
+	}
+
+	return leaked_elements().end();
+}
+
+template<typename T>
+inline typename CowVector<T>::const_iterator
+CowVector<T>::end() const noexcept
+{
+	return _buffer ? _buffer->elements.end() : nullptr;
+}
+
+template<typename T>
+inline typename CowVector<T>::const_iterator
+CowVector<T>::cend() const noexcept
+{
+	return end();
+}
+
+template<typename T>
+inline typename CowVector<T>::reference
+CowVector<T>::front()
+{
+	return leaked_elements().front();
+}
+
+template<typename T>
+inline typename CowVector<T>::const_reference
+CowVector<T>::front() const
+{
+	if (empty())
+	{
+		VectorErrorPolicy::raise(VectorError::Range, "CowVector::front -- empty vector");
+	}
+
+	return _buffer->elements.front();
+}
+
+template<typename T>
+inline typename CowVector<T>::reference
+CowVector<T>::back()
+{
+	return leaked_elements().back();
+}
+
+template<typename T>
+inline typename CowVector<T>::const_reference
+CowVector<T>::back() const
+{
+	if (empty())
+	{
+		VectorErrorPolicy::raise(VectorError::Range, "CowVector::back -- empty vector");
+	}
+
+	return _buffer->elements.back();
+}
+
+template<typename T>
+inline typename CowVector<T>::pointer
+CowVector<T>::data()
+{
+	if (empty())
+	{
+		return const_cast<pointer>(std::as_const(*this).data());
+	}
+
+	return leaked_elements().data();
+}
+
+template<typename T>
+inline typename CowVector<T>::const_pointer
+CowVector<T>::data() const noexcept
+{
+	return _buffer ? _buffer->elements.data() : nullptr;
+}
+
+template<typename T>
+Vector<T>& CowVector<T>::mutable_elements()
+{
+	if (!_buffer)
+	{
+		_buffer = new SharedBuffer();
+	}
+	else
+	{
+		unshare();
+	}
+
+	return _buffer->elements;
+}
+
+template<typename T>
+Vector<T>& CowVector<T>::leaked_elements()
+{
+	Vector<T>& elements = mutable_elements();
+	_buffer->unshareable = true;
+
+	return elements;
+}
+
+// Every reference into the old storage is invalid once the buffer moved, so
+// none of them can write behind a later copy's back.
+template<typename T>
+inline void CowVector<T>::forget_leaks_if_reallocated(const_pointer previous) noexcept
+{
+	if (_buffer->elements.data() != previous)
+	{
+		_buffer->unshareable = false;
+	}
+}
+
+// Returns the buffer a copy of a CowVector using buffer should hold.
+template<typename T>
+typename CowVector<T>::SharedBuffer*
+CowVector<T>::share(SharedBuffer* buffer)
+{
+	if (!buffer)
+	{
+		return nullptr;
+	}
+
+	if (buffer->unshareable)
+	{
+		return new SharedBuffer(std::as_const(buffer->elements));
+	}
+
+	buffer->refCount.fetch_add(1, std::memory_order_relaxed);
+
+	return buffer;
+}
+
+template<typename T>
+inline void CowVector<T>::release() noexcept
+{
+	if (_buffer && _buffer->refCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{
+		delete _buffer;
+	}
+
+	_buffer = nullptr;
+}
+
+template<typename T>
+inline bool operator==(const CowVector<T>& a, const CowVector<T>& b)
+{
+	return ((a.size() == b.size()) && std::equal(a.begin(), a.end(), b.begin()));
+}
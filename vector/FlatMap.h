@@ -0,0 +1,662 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include "Vector.h"
+
+///////////////////////////////////////////////////////////////////////////////
+/// branchless_lower_bound
+///
+/// std::lower_bound without the data dependent branch: every step narrows the
+/// range with a conditional move, so the loop runs log2(n) times regardless of
+/// the key and doesn't suffer branch mispredictions.
+///
+template<typename Iterator, typename Key, typename Compare>
+Iterator branchless_lower_bound(Iterator first, Iterator last, const Key& key, Compare compare)
+{
+	auto length = last - first;
+
+	if (length == 0)
+	{
+		return first;
+	}
+
+	while (length > 1)
+	{
+		const auto half = length / 2;
+
+		first = compare(first[half], key) ? first + half : first;
+		length -= half;
+	}
+
+	return compare(*first, key) ? first + 1 : first;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// flat_bulk_insert
+///
+/// Appends [first, last) to a sorted, unique Vector, sorts only the new tail,
+/// merges it into the old elements once and drops the duplicates. Elements
+/// that were already present win over equal new ones, as do earlier new
+/// elements over later ones.
+///
+/// If copying an element or the comparator throws while the new tail is
+/// appended or sorted, the tail is erased and the Vector is as it was. Once
+/// the merge has started old and new elements are interleaved, so a throw
+/// from there on empties the Vector; either way it stays sorted and unique.
+///
+template<typename T, typename InputIterator, typename KeyCompare>
+void flat_bulk_insert(Vector<T>& elements, InputIterator first, InputIterator last, KeyCompare compare)
+{
+	const std::size_t oldSize = elements.size();
+
+	elements.append(first, last);
+
+	if (elements.size() == oldSize)
+	{
+		return;
+	}
+
+	T* const begin = elements.begin();
+	T* const middle = begin + oldSize;
+	T* const end = elements.end();
+	bool merging = false;
+
+	VECTOR_TRY
+	{
+		std::stable_sort(middle, end, compare);
+
+		merging = true;
+		std::inplace_merge(begin, middle, end, compare);
+
+		T* const newEnd = std::unique(begin, end, [&compare](const T& a, const T& b)
+		{
+			return !compare(a, b) && !compare(b, a);
+		});
+
+		elements.erase(newEnd, end);
+	}
+	VECTOR_CATCH_ALL
+	{
+		if (merging)
+		{
+			elements.clear();
+		}
+		else
+		{
+			elements.erase(middle, end);
+		}
+
+		VECTOR_RETHROW;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// FlatSet
+///
+/// Sorted set stored contiguously in a Vector. Lookups are a branchless binary
+/// search; single inserts and erases shift the tail, so prefer the bulk
+/// insert(first, last) when adding many keys at once.
+///
+template<typename K, typename Compare = std::less<K>>
+class FlatSet
+{
+public:
+	typedef                    std::size_t size_type;
+	typedef                    std::ptrdiff_t difference_type;
+
+	typedef                    K key_type;
+	typedef                    K value_type;
+	typedef                    Compare key_compare;
+
+	typedef const              K* iterator;
+	typedef const              K* const_iterator;
+
+	typedef const              K& reference;
+	typedef const              K& const_reference;
+
+public:
+	FlatSet() = default;
+	FlatSet(std::initializer_list<K> ilist);
+	template<typename InputIterator>
+	FlatSet(InputIterator first, InputIterator last);
+
+public:
+	std::pair<iterator, bool> insert(const K& key);
+	std::pair<iterator, bool> insert(K&& key);
+	template<typename InputIterator>
+	void insert(InputIterator first, InputIterator last);
+
+	iterator erase(const_iterator pos);
+	size_type erase(const K& key);
+
+	iterator find(const K& key) const;
+	bool contains(const K& key) const;
+	size_type count(const K& key) const;
+	iterator lower_bound(const K& key) const;
+	iterator upper_bound(const K& key) const;
+
+public:
+	bool empty() const noexcept;
+	size_type size() const noexcept;
+	size_type capacity() const noexcept;
+	void reserve(const size_type newCapacity);
+	void clear() noexcept;
+
+public:
+	const_iterator             begin() const noexcept;
+	const_iterator             cbegin() const noexcept;
+
+	const_iterator             end() const noexcept;
+	const_iterator             cend() const noexcept;
+
+private:
+	template<typename U>
+	std::pair<iterator, bool> insert_internal(U&& key);
+
+private:
+	Vector<K> _keys;
+	Compare _compare;
+};
+
+template<typename K, typename Compare>
+FlatSet<K, Compare>::FlatSet(std::initializer_list<K> ilist)
+{
+	insert(ilist.begin(), ilist.end());
+}
+
+template<typename K, typename Compare>
+template<typename InputIterator>
+FlatSet<K, Compare>::FlatSet(InputIterator first, InputIterator last)
+{
+	insert(first, last);
+}
+
+template<typename K, typename Compare>
+std::pair<typename FlatSet<K, Compare>::iterator, bool>
+FlatSet<K, Compare>::insert(const K& key)
+{
+	return insert_internal(key);
+}
+
+template<typename K, typename Compare>
+std::pair<typename FlatSet<K, Compare>::iterator, bool>
+FlatSet<K, Compare>::insert(K&& key)
+{
+	return insert_internal(std::move(key));
+}
+
+template<typename K, typename Compare>
+template<typename InputIterator>
+void FlatSet<K, Compare>::insert(InputIterator first, InputIterator last)
+{
+	flat_bulk_insert(_keys, first, last, _compare);
+}
+
+template<typename K, typename Compare>
+typename FlatSet<K, Compare>::iterator
+FlatSet<K, Compare>::erase(const_iterator pos)
+{
+	return _keys.erase(const_cast<K*>(pos));
+}
+
+template<typename K, typename Compare>
+typename FlatSet<K, Compare>::size_type
+FlatSet<K, Compare>::erase(const K& key)
+{
+	iterator position = find(key);
+
+	if (position == end())
+	{
+		return 0;
+	}
+
+	erase(position);
+
+	return 1;
+}
+
+template<typename K, typename Compare>
+typename FlatSet<K, Compare>::iterator
+FlatSet<K, Compare>::find(const K& key) const
+{
+	iterator position = lower_bound(key);
+
+	return (position != end() && !_compare(key, *position)) ? position : end();
+}
+
+template<typename K, typename Compare>
+inline bool FlatSet<K, Compare>::contains(const K& key) const
+{
+	return find(key) != end();
+}
+
+template<typename K, typename Compare>
+inline typename FlatSet<K, Compare>::size_type
+FlatSet<K, Compare>::count(const K& key) const
+{
+	return contains(key) ? 1 : 0;
+}
+
+template<typename K, typename Compare>
+inline typename FlatSet<K, Compare>::iterator
+FlatSet<K, Compare>::lower_bound(const K& key) const
+{
+	return branchless_lower_bound(begin(), end(), key, _compare);
+}
+
+template<typename K, typename Compare>
+inline typename FlatSet<K, Compare>::iterator
+FlatSet<K, Compare>::upper_bound(const K& key) const
+{
+	return std::upper_bound(begin(), end(), key, _compare);
+}
+
+template<typename K, typename Compare>
+inline bool FlatSet<K, Compare>::empty() const noexcept
+{
+	return _keys.empty();
+}
+
+template<typename K, typename Compare>
+inline typename FlatSet<K, Compare>::size_type
+FlatSet<K, Compare>::size() const noexcept
+{
+	return _keys.size();
+}
+
+template<typename K, typename Compare>
+inline typename FlatSet<K, Compare>::size_type
+FlatSet<K, Compare>::capacity() const noexcept
+{
+	return _keys.capacity();
+}
+
+template<typename K, typename Compare>
+inline void FlatSet<K, Compare>::reserve(const size_type newCapacity)
+{
+	_keys.reserve(newCapacity);
+}
+
+template<typename K, typename Compare>
+inline void FlatSet<K, Compare>::clear() noexcept
+{
+	_keys.clear();
+}
+
+template<typename K, typename Compare>
+inline typename FlatSet<K, Compare>::const_iterator
+FlatSet<K, Compare>::begin() const noexcept
+{
+	return _keys.begin();
+}
+
+template<typename K, typename Compare>
+inline typename FlatSet<K, Compare>::const_iterator
+FlatSet<K, Compare>::cbegin() const noexcept
+{
+	return _keys.cbegin();
+}
+
+template<typename K, typename Compare>
+inline typename FlatSet<K, Compare>::const_iterator
+FlatSet<K, Compare>::end() const noexcept
+{
+	return _keys.end();
+}
+
+template<typename K, typename Compare>
+inline typename FlatSet<K, Compare>::const_iterator
+FlatSet<K, Compare>::cend() const noexcept
+{
+	return _keys.cend();
+}
+
+template<typename K, typename Compare>
+template<typename U>
+std::pair<typename FlatSet<K, Compare>::iterator, bool>
+FlatSet<K, Compare>::insert_internal(U&& key)
+{
+	iterator position = lower_bound(key);
+
+	if (position != end() && !_compare(key, *position))
+	{
+		return { position, false };
+	}
+
+	return { _keys.insert(position, std::forward<U>(key)), true };
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// FlatMap
+///
+/// Sorted map stored contiguously in a Vector of key/value pairs, with the
+/// same lookup and bulk insert strategy as FlatSet. Iterators expose the pairs
+/// directly; the keys must not be modified through them.
+///
+template<typename K, typename V, typename Compare = std::less<K>>
+class FlatMap
+{
+public:
+	typedef                    std::size_t size_type;
+	typedef                    std::ptrdiff_t difference_type;
+
+	typedef                    K key_type;
+	typedef                    V mapped_type;
+	typedef                    std::pair<K, V> value_type;
+	typedef                    Compare key_compare;
+
+	typedef                    value_type* iterator;
+	typedef const              value_type* const_iterator;
+
+	typedef                    value_type& reference;
+	typedef const              value_type& const_reference;
+
+public:
+	FlatMap() = default;
+	FlatMap(std::initializer_list<value_type> ilist);
+	template<typename InputIterator>
+	FlatMap(InputIterator first, InputIterator last);
+
+public:
+	std::pair<iterator, bool> insert(const value_type& value);
+	std::pair<iterator, bool> insert(value_type&& value);
+	template<typename InputIterator>
+	void insert(InputIterator first, InputIterator last);
+
+	template<class... Args>
+	std::pair<iterator, bool> try_emplace(const K& key, Args&& ... args);
+	template<typename M>
+	std::pair<iterator, bool> insert_or_assign(const K& key, M&& value);
+
+	iterator erase(const_iterator pos);
+	size_type erase(const K& key);
+
+	V& operator[](const K& key);
+	V& at(const K& key);
+	const V& at(const K& key) const;
+
+	iterator find(const K& key);
+	const_iterator find(const K& key) const;
+	bool contains(const K& key) const;
+	size_type count(const K& key) const;
+	iterator lower_bound(const K& key);
+	const_iterator lower_bound(const K& key) const;
+
+public:
+	bool empty() const noexcept;
+	size_type size() const noexcept;
+	size_type capacity() const noexcept;
+	void reserve(const size_type newCapacity);
+	void clear() noexcept;
+
+public:
+	iterator                   begin() noexcept;
+	const_iterator             begin() const noexcept;
+	const_iterator             cbegin() const noexcept;
+
+	iterator                   end() noexcept;
+	const_iterator             end() const noexcept;
+	const_iterator             cend() const noexcept;
+
+private:
+	struct KeyCompare
+	{
+		bool operator()(const value_type& a, const value_type& b) const { return compare(a.first, b.first); }
+		bool operator()(const value_type& a, const K& b) const { return compare(a.first, b); }
+
+		Compare compare;
+	};
+
+	bool matches(const_iterator position, const K& key) const;
+
+private:
+	Vector<value_type> _elements;
+	KeyCompare _compare;
+};
+
+template<typename K, typename V, typename Compare>
+FlatMap<K, V, Compare>::FlatMap(std::initializer_list<value_type> ilist)
+{
+	insert(ilist.begin(), ilist.end());
+}
+
+template<typename K, typename V, typename Compare>
+template<typename InputIterator>
+FlatMap<K, V, Compare>::FlatMap(InputIterator first, InputIterator last)
+{
+	insert(first, last);
+}
+
+template<typename K, typename V, typename Compare>
+std::pair<typename FlatMap<K, V, Compare>::iterator, bool>
+FlatMap<K, V, Compare>::insert(const value_type& value)
+{
+	return try_emplace(value.first, value.second);
+}
+
+template<typename K, typename V, typename Compare>
+std::pair<typename FlatMap<K, V, Compare>::iterator, bool>
+FlatMap<K, V, Compare>::insert(value_type&& value)
+{
+	iterator position = lower_bound(value.first);
+
+	if (matches(position, value.first))
+	{
+		return { position, false };
+	}
+
+	return { _elements.insert(position, std::move(value)), true };
+}
+
+template<typename K, typename V, typename Compare>
+template<typename InputIterator>
+void FlatMap<K, V, Compare>::insert(InputIterator first, InputIterator last)
+{
+	flat_bulk_insert(_elements, first, last, _compare);
+}
+
+template<typename K, typename V, typename Compare>
+template<class... Args>
+std::pair<typename FlatMap<K, V, Compare>::iterator, bool>
+FlatMap<K, V, Compare>::try_emplace(const K& key, Args&& ... args)
+{
+	iterator position = lower_bound(key);
+
+	if (matches(position, key))
+	{
+		return { position, false };
+	}
+
+	iterator inserted = _elements.emplace(position, std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(std::forward<Args>(args)...));
+
+	return { inserted, true };
+}
+
+template<typename K, typename V, typename Compare>
+template<typename M>
+std::pair<typename FlatMap<K, V, Compare>::iterator, bool>
+FlatMap<K, V, Compare>::insert_or_assign(const K& key, M&& value)
+{
+	auto result = try_emplace(key, std::forward<M>(value));
+
+	if (!result.second)
+	{
+		result.first->second = std::forward<M>(value);
+	}
+
+	return result;
+}
+
+template<typename K, typename V, typename Compare>
+typename FlatMap<K, V, Compare>::iterator
+FlatMap<K, V, Compare>::erase(const_iterator pos)
+{
+	return _elements.erase(const_cast<iterator>(pos));
+}
+
+template<typename K, typename V, typename Compare>
+typename FlatMap<K, V, Compare>::size_type
+FlatMap<K, V, Compare>::erase(const K& key)
+{
+	iterator position = find(key);
+
+	if (position == end())
+	{
+		return 0;
+	}
+
+	erase(position);
+
+	return 1;
+}
+
+template<typename K, typename V, typename Compare>
+V& FlatMap<K, V, Compare>::operator[](const K& key)
+{
+	return try_emplace(key).first->second;
+}
+
+template<typename K, typename V, typename Compare>
+V& FlatMap<K, V, Compare>::at(const K& key)
+{
+	return const_cast<V&>(std::as_const(*this).at(key));
+}
+
+template<typename K, typename V, typename Compare>
+const V& FlatMap<K, V, Compare>::at(const K& key) const
+{
+	const_iterator position = find(key);
+
+	if (position == end())
+	{
+		VectorErrorPolicy::raise(VectorError::OutOfRange, "FlatMap::at -- key not found");
+	}
+
+	return position->second;
+}
+
+template<typename K, typename V, typename Compare>
+typename FlatMap<K, V, Compare>::iterator
+FlatMap<K, V, Compare>::find(const K& key)
+{
+	return const_cast<iterator>(std::as_const(*this).find(key));
+}
+
+template<typename K, typename V, typename Compare>
+typename FlatMap<K, V, Compare>::const_iterator
+FlatMap<K, V, Compare>::find(const K& key) const
+{
+	const_iterator position = lower_bound(key);
+
+	return matches(position, key) ? position : end();
+}
+
+template<typename K, typename V, typename Compare>
+inline bool FlatMap<K, V, Compare>::contains(const K& key) const
+{
+	return find(key) != end();
+}
+
+template<typename K, typename V, typename Compare>
+inline typename FlatMap<K, V, Compare>::size_type
+FlatMap<K, V, Compare>::count(const K& key) const
+{
+	return contains(key) ? 1 : 0;
+}
+
+template<typename K, typename V, typename Compare>
+inline typename FlatMap<K, V, Compare>::iterator
+FlatMap<K, V, Compare>::lower_bound(const K& key)
+{
+	return const_cast<iterator>(std::as_const(*this).lower_bound(key));
+}
+
+template<typename K, typename V, typename Compare>
+inline typename FlatMap<K, V, Compare>::const_iterator
+FlatMap<K, V, Compare>::lower_bound(const K& key) const
+{
+	return branchless_lower_bound(begin(), end(), key, _compare);
+}
+
+template<typename K, typename V, typename Compare>
+inline bool FlatMap<K, V, Compare>::empty() const noexcept
+{
+	return _elements.empty();
+}
+
+template<typename K, typename V, typename Compare>
+inline typename FlatMap<K, V, Compare>::size_type
+FlatMap<K, V, Compare>::size() const noexcept
+{
+	return _elements.size();
+}
+
+template<typename K, typename V, typename Compare>
+inline typename FlatMap<K, V, Compare>::size_type
+FlatMap<K, V, Compare>::capacity() const noexcept
+{
+	return _elements.capacity();
+}
+
+template<typename K, typename V, typename Compare>
+inline void FlatMap<K, V, Compare>::reserve(const size_type newCapacity)
+{
+	_elements.reserve(newCapacity);
+}
+
+template<typename K, typename V, typename Compare>
+inline void FlatMap<K, V, Compare>::clear() noexcept
+{
+	_elements.clear();
+}
+
+template<typename K, typename V, typename Compare>
+inline typename FlatMap<K, V, Compare>::iterator
+FlatMap<K, V, Compare>::begin() noexcept
+{
+	return _elements.begin();
+}
+
+template<typename K, typename V, typename Compare>
+inline typename FlatMap<K, V, Compare>::const_iterator
+FlatMap<K, V, Compare>::begin() const noexcept
+{
+	return _elements.begin();
+}
+
+template<typename K, typename V, typename Compare>
+inline typename FlatMap<K, V, Compare>::const_iterator
+FlatMap<K, V, Compare>::cbegin() const noexcept
+{
+	return _elements.cbegin();
+}
+
+template<typename K, typename V, typename Compare>
+inline typename FlatMap<K, V, Compare>::iterator
+FlatMap<K, V, Compare>::end() noexcept
+{
+	return _elements.end();
+}
+
+template<typename K, typename V, typename Compare>
+inline typename FlatMap<K, V, Compare>::const_iterator
+FlatMap<K, V, Compare>::end() const noexcept
+{
+	return _elements.end();
+}
+
+template<typename K, typename V, typename Compare>
+inline typename FlatMap<K, V, Compare>::const_iterator
+FlatMap<K, V, Compare>::cend() const noexcept
+{
+	return _elements.cend();
+}
+
+template<typename K, typename V, typename Compare>
+inline bool FlatMap<K, V, Compare>::matches(const_iterator position, const K& key) const
+{
+	return position != end() && !_compare.compare(key, position->first);
+}
@@ -0,0 +1,262 @@
+#pragma once
+
+#include <initializer_list>
+#include <iterator>
+#include <utility>
+#include "Span.h"
+#include "Vector.h"
+
+///////////////////////////////////////////////////////////////////////////////
+/// JaggedVector
+///
+/// A sequence of variable-length rows stored in compressed sparse row form:
+/// every value lives in one contiguous Vector and a second Vector holds the
+/// offset at which each row starts. Compared to Vector<Vector<T>> this is two
+/// allocations instead of one per row, and a traversal walks memory linearly.
+///
+/// Rows can only be appended, and only the last row can grow in place.
+///
+template<typename T>
+class JaggedVector
+{
+public:
+	typedef                    std::size_t size_type;
+	typedef                    std::ptrdiff_t difference_type;
+
+	typedef                    T value_type;
+
+	typedef                    Span<T> row_type;
+	typedef                    Span<const T> const_row_type;
+
+public:
+	JaggedVector() = default;
+
+	/// Converts nested vectors in two passes: the first sizes both arrays,
+	/// the second copies the values, so neither array reallocates.
+	static JaggedVector<T> from_nested(const Vector<Vector<T>>& nested);
+
+public:
+	template<typename InputIterator>
+	row_type append_row(InputIterator first, InputIterator last);
+	row_type append_row(std::initializer_list<T> ilist);
+	template<typename Range>
+	row_type append_row(const Range& range);
+	row_type append_empty_row();
+
+	/// Appends a value to the last row; throws std::range_error if there are no rows.
+	void push_back_to_last_row(const T& value);
+	void push_back_to_last_row(T&& value);
+
+	row_type row(const size_type n) noexcept;
+	const_row_type row(const size_type n) const noexcept;
+
+	row_type at(const size_type n);
+	const_row_type at(const size_type n) const;
+
+public:
+	bool empty() const noexcept;
+	size_type row_count() const noexcept;
+	size_type value_count() const noexcept;
+	void reserve(const size_type rowCount, const size_type valueCount);
+
+	Span<T> values() noexcept;
+	Span<const T> values() const noexcept;
+
+private:
+	void begin_row();
+	void end_row();
+
+private:
+	Vector<T> _values;
+	Vector<size_type> _offsets;
+};
+
+template<typename T>
+JaggedVector<T> JaggedVector<T>::from_nested(const Vector<Vector<T>>& nested)
+{
+	size_type valueCount = 0;
+
+	for (const Vector<T>& row : nested)
+	{
+		valueCount += row.size();
+	}
+
+	JaggedVector<T> jagged;
+	jagged.reserve(nested.size(), valueCount);
+
+	for (const Vector<T>& row : nested)
+	{
+		jagged.append_row(row.begin(), row.end());
+	}
+
+	return jagged;
+}
+
+template<typename T>
+template<typename InputIterator>
+typename JaggedVector<T>::row_type
+JaggedVector<T>::append_row(InputIterator first, InputIterator last)
+{
+	begin_row();
+
+	const size_type rowStart = _values.size();
+
+	// append() grows geometrically and rolls back its own partial output, so
+	// building row by row stays amortised O(1) per value.
+	_values.append(first, last);
+
+	VECTOR_TRY
+	{
+		end_row();
+	}
+	VECTOR_CATCH_ALL
+	{
+		_values.erase(_values.begin() + rowStart, _values.end());
+		VECTOR_RETHROW;
+	}
+
+	return row(row_count() - 1);
+}
+
+template<typename T>
+typename JaggedVector<T>::row_type
+JaggedVector<T>::append_row(std::initializer_list<T> ilist)
+{
+	return append_row(ilist.begin(), ilist.end());
+}
+
+template<typename T>
+template<typename Range>
+typename JaggedVector<T>::row_type
+JaggedVector<T>::append_row(const Range& range)
+{
+	return append_row(std::begin(range), std::end(range));
+}
+
+template<typename T>
+typename JaggedVector<T>::row_type
+JaggedVector<T>::append_empty_row()
+{
+	begin_row();
+	end_row();
+
+	return row(row_count() - 1);
+}
+
+template<typename T>
+void JaggedVector<T>::push_back_to_last_row(const T& value)
+{
+	if (empty())
+	{
+		VectorErrorPolicy::raise(VectorError::Range, "JaggedVector::push_back_to_last_row -- no rows");
+	}
+
+	_values.push_back(value);
+	_offsets.back() = _values.size();
+}
+
+template<typename T>
+void JaggedVector<T>::push_back_to_last_row(T&& value)
+{
+	if (empty())
+	{
+		VectorErrorPolicy::raise(VectorError::Range, "JaggedVector::push_back_to_last_row -- no rows");
+	}
+
+	_values.push_back(std::move(value));
+	_offsets.back() = _values.size();
+}
+
+template<typename T>
+inline typename JaggedVector<T>::row_type
+JaggedVector<T>::row(const size_type n) noexcept
+{
+	return row_type(_values.data() + _offsets[n], _offsets[n + 1] - _offsets[n]);
+}
+
+template<typename T>
+inline typename JaggedVector<T>::const_row_type
+JaggedVector<T>::row(const size_type n) const noexcept
+{
+	return const_row_type(_values.data() + _offsets[n], _offsets[n + 1] - _offsets[n]);
+}
+
+template<typename T>
+typename JaggedVector<T>::row_type
+JaggedVector<T>::at(const size_type n)
+{
+	if (n >= row_count())
+	{
+		VectorErrorPolicy::raise(VectorError::OutOfRange, "JaggedVector::at -- out of range");
+	}
+
+	return row(n);
+}
+
+template<typename T>
+typename JaggedVector<T>::const_row_type
+JaggedVector<T>::at(const size_type n) const
+{
+	if (n >= row_count())
+	{
+		VectorErrorPolicy::raise(VectorError::OutOfRange, "JaggedVector::at -- out of range");
+	}
+
+	return row(n);
+}
+
+template<typename T>
+inline bool JaggedVector<T>::empty() const noexcept
+{
+	return row_count() == 0;
+}
+
+template<typename T>
+inline typename JaggedVector<T>::size_type
+JaggedVector<T>::row_count() const noexcept
+{
+	return _offsets.empty() ? 0 : _offsets.size() - 1;
+}
+
+template<typename T>
+inline typename JaggedVector<T>::size_type
+JaggedVector<T>::value_count() const noexcept
+{
+	return _values.size();
+}
+
+template<typename T>
+void JaggedVector<T>::reserve(const size_type rowCount, const size_type valueCount)
+{
+	_offsets.reserve(rowCount + 1);
+	_values.reserve(valueCount);
+}
+
+template<typename T>
+inline Span<T> JaggedVector<T>::values() noexcept
+{
+	return Span<T>(_values.data(), _values.size());
+}
+
+template<typename T>
+inline Span<const T> JaggedVector<T>::values() const noexcept
+{
+	return Span<const T>(_values.data(), _values.size());
+}
+
+// _offsets holds row_count() + 1 entries once the first row exists, so the
+// end of row i is always _offsets[i + 1].
+template<typename T>
+inline void JaggedVector<T>::begin_row()
+{
+	if (_offsets.empty())
+	{
+		_offsets.push_back(0);
+	}
+}
+
+template<typename T>
+inline void JaggedVector<T>::end_row()
+{
+	_offsets.push_back(_values.size());
+}
@@ -0,0 +1,405 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include "Vector.h"
+
+///////////////////////////////////////////////////////////////////////////////
+/// PackedEncoding
+///
+/// How PackedVector reduces each block of values before bit packing.
+///
+/// FrameOfReference - stores value - min(block); small values and values
+///                    clustered around any base pack into a few bits.
+/// Delta            - stores each value's distance from base + i * step,
+///                    where step is the average difference between
+///                    neighbours in a sorted block. Sorted IDs and
+///                    timestamps with regular gaps shrink to their jitter;
+///                    blocks that aren't sorted fall back to frame of
+///                    reference. Unlike running deltas this keeps random
+///                    access O(1).
+///
+enum class PackedEncoding
+{
+	FrameOfReference,
+	Delta
+};
+
+///////////////////////////////////////////////////////////////////////////////
+/// PackedVector
+///
+/// Append-only integer vector that stores its values in blocks of 128, each
+/// reduced by the chosen encoding and bit packed at the width of its largest
+/// residual. Values are appended to an uncompressed tail block, which is packed
+/// when it is full and the next value arrives.
+///
+/// operator[] decodes a single value in O(1). Scans should go through
+/// for_each or decode_block, which unpack a whole block with a routine
+/// specialised for its bit width, so that the shifts and masks are constants
+/// the compiler can unroll and vectorize.
+///
+template<typename Int>
+class PackedVector
+{
+	static_assert(std::is_integral_v<Int> && !std::is_same_v<Int, bool>, "PackedVector stores integers");
+	static_assert(sizeof(Int) <= sizeof(std::uint64_t), "PackedVector stores integers of up to 64 bits");
+
+public:
+	typedef                    std::size_t size_type;
+	typedef                    Int value_type;
+
+	static constexpr size_type kBlockSize = 128;
+
+public:
+	explicit PackedVector(PackedEncoding encoding = PackedEncoding::FrameOfReference) noexcept;
+
+public:
+	void push_back(const Int value);
+
+	Int operator[](const size_type n) const noexcept;
+	Int at(const size_type n) const;
+
+	/// Writes the values of block n (kBlockSize of them, fewer for the tail)
+	/// to out and returns how many were written.
+	size_type decode_block(const size_type n, Int* out) const noexcept;
+
+	/// Calls function(value) for every value in order.
+	template<typename Function>
+	void for_each(Function function) const;
+
+public:
+	bool empty() const noexcept;
+	size_type size() const noexcept;
+	size_type block_count() const noexcept;
+	PackedEncoding encoding() const noexcept;
+
+	/// Bytes held by the packed words, block headers and tail.
+	size_type memory_bytes() const noexcept;
+
+private:
+	typedef std::make_unsigned_t<Int> bits_type;
+
+	struct block_header
+	{
+		bits_type base;
+		bits_type step;
+		std::uint32_t wordOffset;
+		std::uint8_t bitWidth;
+	};
+
+	typedef void (*unpack_function)(const std::uint64_t* words, bits_type base, bits_type step, Int* out);
+
+	void pack_tail();
+
+	static std::uint64_t extract(const std::uint64_t* words, const size_type index, const unsigned bitWidth) noexcept;
+	template<unsigned BitWidth>
+	static void unpack(const std::uint64_t* words, bits_type base, bits_type step, Int* out);
+	template<std::size_t... BitWidths>
+	static constexpr std::array<unpack_function, sizeof...(BitWidths)> make_unpackers(std::index_sequence<BitWidths...>);
+
+private:
+	Vector<std::uint64_t> _words;
+	Vector<block_header> _blocks;
+	std::array<Int, kBlockSize> _tail;
+	size_type _tailSize;
+	PackedEncoding _encoding;
+};
+
+template<typename Int>
+PackedVector<Int>::PackedVector(PackedEncoding encoding) noexcept
+	:
+	_tail(),
+	_tailSize(0),
+	_encoding(encoding)
+{
+}
+
+// A full tail is packed by the next push_back rather than the one that filled
+// it, so a failed pack leaves the vector unchanged instead of holding a full
+// tail with nowhere to put the next value.
+template<typename Int>
+void PackedVector<Int>::push_back(const Int value)
+{
+	if (_tailSize == kBlockSize)
+	{
+		pack_tail();
+	}
+
+	_tail[_tailSize] = value;
+	_tailSize += 1;
+}
+
+template<typename Int>
+Int PackedVector<Int>::operator[](const size_type n) const noexcept
+{
+	const size_type blockIndex = n / kBlockSize;
+	const size_type index = n % kBlockSize;
+
+	if (blockIndex == _blocks.size())
+	{
+		return _tail[index];
+	}
+
+	const block_header& block = _blocks[blockIndex];
+	const bits_type residual = static_cast<bits_type>(extract(_words.data() + block.wordOffset, index, block.bitWidth));
+
+	return static_cast<Int>(static_cast<bits_type>(block.base + static_cast<bits_type>(index) * block.step + residual));
+}
+
+template<typename Int>
+Int PackedVector<Int>::at(const size_type n) const
+{
+	if (n >= size())
+	{
+		VectorErrorPolicy::raise(VectorError::OutOfRange, "PackedVector::at -- out of range");
+	}
+
+	return (*this)[n];
+}
+
+template<typename Int>
+typename PackedVector<Int>::size_type
+PackedVector<Int>::decode_block(const size_type n, Int* out) const noexcept
+{
+	static constexpr std::array<unpack_function, 65> unpackers = make_unpackers(std::make_index_sequence<65>());
+
+	if (n == _blocks.size())
+	{
+		std::copy(_tail.begin(), _tail.begin() + _tailSize, out);
+
+		return _tailSize;
+	}
+
+	const block_header& block = _blocks[n];
+	unpackers[block.bitWidth](_words.data() + block.wordOffset, block.base, block.step, out);
+
+	return kBlockSize;
+}
+
+template<typename Int>
+template<typename Function>
+void PackedVector<Int>::for_each(Function function) const
+{
+	std::array<Int, kBlockSize> values;
+
+	for (size_type block = 0; block < block_count(); ++block)
+	{
+		const size_type count = decode_block(block, values.data());
+
+		for (size_type i = 0; i < count; ++i)
+		{
+			function(values[i]);
+		}
+	}
+}
+
+template<typename Int>
+inline bool PackedVector<Int>::empty() const noexcept
+{
+	return size() == 0;
+}
+
+template<typename Int>
+inline typename PackedVector<Int>::size_type
+PackedVector<Int>::size() const noexcept
+{
+	return _blocks.size() * kBlockSize + _tailSize;
+}
+
+template<typename Int>
+inline typename PackedVector<Int>::size_type
+PackedVector<Int>::block_count() const noexcept
+{
+	return _blocks.size() + (_tailSize > 0 ? 1 : 0);
+}
+
+template<typename Int>
+inline PackedEncoding PackedVector<Int>::encoding() const noexcept
+{
+	return _encoding;
+}
+
+template<typename Int>
+typename PackedVector<Int>::size_type
+PackedVector<Int>::memory_bytes() const noexcept
+{
+	return _words.capacity() * sizeof(std::uint64_t) + _blocks.capacity() * sizeof(block_header) + sizeof(_tail);
+}
+
+// Values are reduced in the unsigned type, with the sign bit of signed values
+// flipped so that unsigned order matches signed order. The arithmetic wraps
+// consistently, so base + i * step + residual reproduces every value exactly,
+// the full 64-bit range included.
+template<typename Int>
+void PackedVector<Int>::pack_tail()
+{
+	constexpr bits_type signFlip = std::is_signed_v<Int> ? bits_type(bits_type(1) << (sizeof(Int) * 8 - 1)) : bits_type(0);
+
+	bits_type values[kBlockSize];
+
+	for (size_type i = 0; i < kBlockSize; ++i)
+	{
+		values[i] = static_cast<bits_type>(static_cast<bits_type>(_tail[i]) ^ signFlip);
+	}
+
+	bits_type base = values[0];
+	bits_type step = 0;
+
+	if (_encoding == PackedEncoding::Delta)
+	{
+		const bits_type span = static_cast<bits_type>(values[kBlockSize - 1] - values[0]);
+		bool sorted = true;
+
+		for (size_type i = 1; i < kBlockSize; ++i)
+		{
+			sorted = sorted && values[i] >= values[i - 1];
+		}
+
+		if (sorted && span <= std::numeric_limits<bits_type>::max() / 2)
+		{
+			step = static_cast<bits_type>(span / (kBlockSize - 1));
+		}
+	}
+
+	if (step == 0)
+	{
+		for (size_type i = 1; i < kBlockSize; ++i)
+		{
+			base = std::min(base, values[i]);
+		}
+	}
+	else
+	{
+		// In a sorted block every value lies within span of the line through
+		// the first value, so the deviations shifted up by span are
+		// non-negative and base is the line moved down to the lowest of them.
+		const bits_type span = static_cast<bits_type>(values[kBlockSize - 1] - values[0]);
+		bits_type lowest = std::numeric_limits<bits_type>::max();
+
+		for (size_type i = 0; i < kBlockSize; ++i)
+		{
+			lowest = std::min(lowest, static_cast<bits_type>(values[i] - values[0] - static_cast<bits_type>(i) * step + span));
+		}
+
+		base = static_cast<bits_type>(values[0] - span + lowest);
+	}
+
+	bits_type largest = 0;
+
+	for (size_type i = 0; i < kBlockSize; ++i)
+	{
+		values[i] = static_cast<bits_type>(values[i] - base - static_cast<bits_type>(i) * step);
+		largest |= values[i];
+	}
+
+	unsigned bitWidth = 0;
+
+	while (bitWidth < sizeof(bits_type) * 8 && (largest >> bitWidth) != 0)
+	{
+		bitWidth += 1;
+	}
+
+	// 128 values of bitWidth bits fill exactly 2 * bitWidth words.
+	const size_type wordOffset = _words.size();
+
+	if (wordOffset > std::numeric_limits<std::uint32_t>::max())
+	{
+		VectorErrorPolicy::raise(VectorError::Length, "PackedVector -- too many packed words");
+	}
+
+	_blocks.push_back(block_header{ static_cast<bits_type>(base ^ signFlip), step, static_cast<std::uint32_t>(wordOffset), static_cast<std::uint8_t>(bitWidth) });
+
+	VECTOR_TRY
+	{
+		for (size_type i = 0; i < 2 * bitWidth; ++i)
+		{
+			_words.push_back(0);
+		}
+	}
+	VECTOR_CATCH_ALL
+	{
+		_words.erase(_words.begin() + wordOffset, _words.end());
+		_blocks.erase(_blocks.end() - 1);
+		VECTOR_RETHROW;
+	}
+
+	std::uint64_t* words = _words.data() + wordOffset;
+
+	for (size_type i = 0; bitWidth > 0 && i < kBlockSize; ++i)
+	{
+		const size_type position = i * bitWidth;
+		const unsigned shift = static_cast<unsigned>(position % 64);
+		const std::uint64_t value = static_cast<std::uint64_t>(values[i]);
+
+		words[position / 64] |= value << shift;
+
+		if (shift + bitWidth > 64)
+		{
+			words[position / 64 + 1] |= value >> (64 - shift);
+		}
+	}
+
+	_tailSize = 0;
+}
+
+template<typename Int>
+inline std::uint64_t PackedVector<Int>::extract(const std::uint64_t* words, const size_type index, const unsigned bitWidth) noexcept
+{
+	if (bitWidth == 0)
+	{
+		return 0;
+	}
+
+	const size_type position = index * bitWidth;
+	const unsigned shift = static_cast<unsigned>(position % 64);
+	const std::uint64_t mask = bitWidth == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << bitWidth) - 1;
+
+	std::uint64_t value = words[position / 64] >> shift;
+
+	if (shift + bitWidth > 64)
+	{
+		value |= words[position / 64 + 1] << (64 - shift);
+	}
+
+	return value & mask;
+}
+
+template<typename Int>
+template<unsigned BitWidth>
+void PackedVector<Int>::unpack(const std::uint64_t* words, bits_type base, bits_type step, Int* out)
+{
+	for (size_type i = 0; i < kBlockSize; ++i)
+	{
+		bits_type residual = 0;
+
+		if constexpr (BitWidth > 0)
+		{
+			constexpr std::uint64_t mask = BitWidth == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << (BitWidth % 64)) - 1;
+
+			const size_type position = i * BitWidth;
+			const unsigned shift = static_cast<unsigned>(position % 64);
+
+			std::uint64_t value = words[position / 64] >> shift;
+
+			if (shift + BitWidth > 64)
+			{
+				value |= words[position / 64 + 1] << ((64 - shift) % 64);
+			}
+
+			residual = static_cast<bits_type>(value & mask);
+		}
+
+		out[i] = static_cast<Int>(static_cast<bits_type>(base + static_cast<bits_type>(i) * step + residual));
+	}
+}
+
+template<typename Int>
+template<std::size_t... BitWidths>
+constexpr std::array<typename PackedVector<Int>::unpack_function, sizeof...(BitWidths)>
+PackedVector<Int>::make_unpackers(std::index_sequence<BitWidths...>)
+{
+	return { { &PackedVector<Int>::unpack<static_cast<unsigned>(BitWidths)>... } };
+}
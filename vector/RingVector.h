@@ -0,0 +1,547 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "Span.h"
+#include "Vector.h"
+
+///////////////////////////////////////////////////////////////////////////////
+/// RingVector
+///
+/// Circular buffer with Vector's storage: one contiguous allocation whose
+/// capacity is always a power of two, so wrapping an index is a mask. Elements
+/// can be added and removed at both ends in O(1), which makes it a drop-in
+/// FIFO where Vector::erase(begin()) would shift the whole array.
+///
+/// Growing the buffer linearizes it: the front element lands at index 0 of the
+/// new allocation. as_spans() exposes the live elements as at most two
+/// contiguous runs, front part first.
+///
+template<typename T>
+class RingVector
+{
+public:
+	typedef                    std::size_t size_type;
+	typedef                    std::ptrdiff_t difference_type;
+
+	typedef                    T value_type;
+
+	typedef                    T& reference;
+	typedef const              T& const_reference;
+
+	typedef                    T* pointer;
+	typedef const              T* const_pointer;
+
+	typedef                    std::pair<Span<T>, Span<T>> span_pair;
+	typedef                    std::pair<Span<const T>, Span<const T>> const_span_pair;
+
+public:
+	RingVector() noexcept;
+	RingVector(std::initializer_list<T> ilist);
+	RingVector(const RingVector<T>& other);
+	RingVector(RingVector<T>&& other) noexcept;
+	~RingVector();
+	RingVector<T>& operator=(const RingVector<T>& other);
+	RingVector<T>& operator=(RingVector<T>&& other) noexcept;
+
+public:
+	template<class... Args>
+	reference emplace_back(Args&& ... args);
+	template<class... Args>
+	reference emplace_front(Args&& ... args);
+
+	void push_back(const T& element);
+	void push_back(T&& element);
+	void push_front(const T& element);
+	void push_front(T&& element);
+
+	void pop_back();
+	void pop_front();
+
+	reference operator[](const size_type n) noexcept;
+	const_reference operator[](const size_type n) const noexcept;
+
+	reference at(const size_type n);
+	const_reference at(const size_type n) const;
+
+public:
+	bool empty() const noexcept;
+	size_type size() const noexcept;
+	size_type capacity() const noexcept;
+	/// The largest power of two Vector can allocate; growing past it reports
+	/// VectorError::Length.
+	static constexpr size_type max_size() noexcept;
+	void reserve(const size_type newCapacity);
+	void clear() noexcept;
+
+	span_pair as_spans() noexcept;
+	const_span_pair as_spans() const noexcept;
+
+public:
+	reference                  front();
+	const_reference            front() const;
+
+	reference                  back();
+	const_reference            back() const;
+
+private:
+	size_type wrap(const size_type index) const noexcept;
+	pointer slot(const size_type n) const noexcept;
+
+	template<class... Args>
+	reference emplace_back_reallocate(Args&& ... args);
+	template<class... Args>
+	reference emplace_front_reallocate(Args&& ... args);
+
+	size_type grown_capacity() const;
+	void reallocate(const size_type newCapacity);
+	static pointer relocate(pointer first, pointer last, pointer dest);
+	void swap(RingVector<T>& other) noexcept;
+
+private:
+	pointer _container;
+	size_type _head;
+	size_type _size;
+	size_type _capacity;
+};
+
+template<typename T>
+RingVector<T>::RingVector() noexcept
+	:
+	_container(nullptr),
+	_head(0),
+	_size(0),
+	_capacity(0)
+{
+}
+
+template<typename T>
+RingVector<T>::RingVector(std::initializer_list<T> ilist)
+	:
+	RingVector()
+{
+	reserve(ilist.size());
+
+	for (const T& element : ilist)
+	{
+		push_back(element);
+	}
+}
+
+template<typename T>
+RingVector<T>::RingVector(const RingVector<T>& other)
+	:
+	RingVector()
+{
+	reserve(other.size());
+
+	for (size_type i = 0; i < other.size(); ++i)
+	{
+		push_back(other[i]);
+	}
+}
+
+template<typename T>
+RingVector<T>::RingVector(RingVector<T>&& other) noexcept
+	:
+	RingVector()
+{
+	swap(other);
+}
+
+template<typename T>
+RingVector<T>::~RingVector()
+{
+	clear();
+	Vector<T>::deallocate_buffer(_container, _capacity);
+}
+
+template<typename T>
+RingVector<T>& RingVector<T>::operator=(const RingVector<T>& other)
+{
+	if (this != &other)
+	{
+		RingVector<T> copy(other);
+		swap(copy);
+	}
+
+	return *this;
+}
+
+template<typename T>
+RingVector<T>& RingVector<T>::operator=(RingVector<T>&& other) noexcept
+{
+	swap(other);
+
+	return *this;
+}
+
+template<typename T>
+template<class... Args>
+typename RingVector<T>::reference
+RingVector<T>::emplace_back(Args&& ... args)
+{
+	if (_size == _capacity)
+	{
+		return emplace_back_reallocate(std::forward<Args>(args)...);
+	}
+
+	pointer element = ::new(static_cast<void*>(slot(_size))) T(std::forward<Args>(args)...);
+	_size += 1;
+
+	return *element;
+}
+
+template<typename T>
+template<class... Args>
+typename RingVector<T>::reference
+RingVector<T>::emplace_front(Args&& ... args)
+{
+	if (_size == _capacity)
+	{
+		return emplace_front_reallocate(std::forward<Args>(args)...);
+	}
+
+	const size_type newHead = wrap(_head + _capacity - 1);
+	pointer element = ::new(static_cast<void*>(_container + newHead)) T(std::forward<Args>(args)...);
+	_head = newHead;
+	_size += 1;
+
+	return *element;
+}
+
+template<typename T>
+void RingVector<T>::push_back(const T& element)
+{
+	emplace_back(element);
+}
+
+template<typename T>
+void RingVector<T>::push_back(T&& element)
+{
+	emplace_back(std::move(element));
+}
+
+template<typename T>
+void RingVector<T>::push_front(const T& element)
+{
+	emplace_front(element);
+}
+
+template<typename T>
+void RingVector<T>::push_front(T&& element)
+{
+	emplace_front(std::move(element));
+}
+
+template<typename T>
+void RingVector<T>::pop_back()
+{
+	if (empty())
+	{
+		VectorErrorPolicy::raise(VectorError::Range, "RingVector::pop_back -- empty vector");
+	}
+
+	_size -= 1;
+	std::destroy_at(slot(_size));
+}
+
+template<typename T>
+void RingVector<T>::pop_front()
+{
+	if (empty())
+	{
+		VectorErrorPolicy::raise(VectorError::Range, "RingVector::pop_front -- empty vector");
+	}
+
+	std::destroy_at(_container + _head);
+	_head = wrap(_head + 1);
+	_size -= 1;
+}
+
+template<typename T>
+inline typename RingVector<T>::reference
+RingVector<T>::operator[](const size_type n) noexcept
+{
+	return *slot(n);
+}
+
+template<typename T>
+inline typename RingVector<T>::const_reference
+RingVector<T>::operator[](const size_type n) const noexcept
+{
+	return *slot(n);
+}
+
+template<typename T>
+typename RingVector<T>::reference
+RingVector<T>::at(const size_type n)
+{
+	return const_cast<reference>(std::as_const(*this).at(n));
+}
+
+template<typename T>
+typename RingVector<T>::const_reference
+RingVector<T>::at(const size_type n) const
+{
+	if (n >= _size)
+	{
+		VectorErrorPolicy::raise(VectorError::OutOfRange, "RingVector::at -- out of range");
+	}
+
+	return *slot(n);
+}
+
+template<typename T>
+inline bool RingVector<T>::empty() const noexcept
+{
+	return _size == 0;
+}
+
+template<typename T>
+inline typename RingVector<T>::size_type
+RingVector<T>::size() const noexcept
+{
+	return _size;
+}
+
+template<typename T>
+inline typename RingVector<T>::size_type
+RingVector<T>::capacity() const noexcept
+{
+	return _capacity;
+}
+
+template<typename T>
+constexpr typename RingVector<T>::size_type
+RingVector<T>::max_size() noexcept
+{
+	size_type maxCapacity = 1;
+
+	while (maxCapacity <= Vector<T>::max_size() / 2)
+	{
+		maxCapacity *= 2;
+	}
+
+	return maxCapacity;
+}
+
+template<typename T>
+void RingVector<T>::reserve(const size_type newCapacity)
+{
+	if (newCapacity <= _capacity)
+	{
+		return;
+	}
+
+	if (newCapacity > max_size())
+	{
+		VectorErrorPolicy::raise(VectorError::Length, "RingVector -- size exceeds max_size()");
+	}
+
+	size_type roundedCapacity = std::max(static_cast<size_type>(2), _capacity);
+
+	while (roundedCapacity < newCapacity)
+	{
+		roundedCapacity *= 2;
+	}
+
+	reallocate(roundedCapacity);
+}
+
+template<typename T>
+void RingVector<T>::clear() noexcept
+{
+	const span_pair halves = as_spans();
+
+	std::destroy(halves.first.begin(), halves.first.end());
+	std::destroy(halves.second.begin(), halves.second.end());
+
+	_head = 0;
+	_size = 0;
+}
+
+template<typename T>
+typename RingVector<T>::span_pair
+RingVector<T>::as_spans() noexcept
+{
+	const size_type firstSize = std::min(_size, _capacity - _head);
+
+	return { Span<T>(_container + _head, firstSize), Span<T>(_container, _size - firstSize) };
+}
+
+template<typename T>
+typename RingVector<T>::const_span_pair
+RingVector<T>::as_spans() const noexcept
+{
+	const size_type firstSize = std::min(_size, _capacity - _head);
+
+	return { Span<const T>(_container + _head, firstSize), Span<const T>(_container, _size - firstSize) };
+}
+
+template<typename T>
+inline typename RingVector<T>::reference
+RingVector<T>::front()
+{
+	return const_cast<reference>(std::as_const(*this).front());
+}
+
+template<typename T>
+inline typename RingVector<T>::const_reference
+RingVector<T>::front() const
+{
+	if (empty())
+	{
+		VectorErrorPolicy::raise(VectorError::Range, "RingVector::front -- empty vector");
+	}
+
+	return *slot(0);
+}
+
+template<typename T>
+inline typename RingVector<T>::reference
+RingVector<T>::back()
+{
+	return const_cast<reference>(std::as_const(*this).back());
+}
+
+template<typename T>
+inline typename RingVector<T>::const_reference
+RingVector<T>::back() const
+{
+	if (empty())
+	{
+		VectorErrorPolicy::raise(VectorError::Range, "RingVector::back -- empty vector");
+	}
+
+	return *slot(_size - 1);
+}
+
+// The capacity is zero or a power of two, so masking wraps any index below
+// twice the capacity.
+template<typename T>
+inline typename RingVector<T>::size_type
+RingVector<T>::wrap(const size_type index) const noexcept
+{
+	return index & (_capacity - 1);
+}
+
+template<typename T>
+inline typename RingVector<T>::pointer
+RingVector<T>::slot(const size_type n) const noexcept
+{
+	return _container + wrap(_head + n);
+}
+
+// The arguments may refer to an element of this ring, so the new element is
+// built before the old buffer goes away.
+template<typename T>
+template<class... Args>
+typename RingVector<T>::reference
+RingVector<T>::emplace_back_reallocate(Args&& ... args)
+{
+	T element(std::forward<Args>(args)...);
+	reallocate(grown_capacity());
+
+	return emplace_back(std::move(element));
+}
+
+template<typename T>
+template<class... Args>
+typename RingVector<T>::reference
+RingVector<T>::emplace_front_reallocate(Args&& ... args)
+{
+	T element(std::forward<Args>(args)...);
+	reallocate(grown_capacity());
+
+	return emplace_front(std::move(element));
+}
+
+template<typename T>
+typename RingVector<T>::size_type
+RingVector<T>::grown_capacity() const
+{
+	if (_capacity >= max_size())
+	{
+		VectorErrorPolicy::raise(VectorError::Length, "RingVector -- size exceeds max_size()");
+	}
+
+	return std::max(static_cast<size_type>(2), _capacity * 2);
+}
+
+template<typename T>
+void RingVector<T>::reallocate(const size_type newCapacity)
+{
+	pointer newContainer = Vector<T>::allocate_buffer(newCapacity);
+	const span_pair halves = as_spans();
+
+	VECTOR_TRY
+	{
+		pointer middle = relocate(halves.first.begin(), halves.first.end(), newContainer);
+
+		VECTOR_TRY
+		{
+			relocate(halves.second.begin(), halves.second.end(), middle);
+		}
+		VECTOR_CATCH_ALL
+		{
+			std::destroy(newContainer, middle);
+			VECTOR_RETHROW;
+		}
+	}
+	VECTOR_CATCH_ALL
+	{
+		Vector<T>::deallocate_buffer(newContainer, newCapacity);
+		VECTOR_RETHROW;
+	}
+
+	std::destroy(halves.first.begin(), halves.first.end());
+	std::destroy(halves.second.begin(), halves.second.end());
+	Vector<T>::deallocate_buffer(_container, _capacity);
+
+	_container = newContainer;
+	_capacity = newCapacity;
+	_head = 0;
+}
+
+// Same choice as Vector::relocate: memcpy trivially copyable elements, move
+// when that can't throw (or copying isn't possible), copy otherwise so a
+// throwing copy leaves the old buffer intact.
+template<typename T>
+typename RingVector<T>::pointer
+RingVector<T>::relocate(pointer first, pointer last, pointer dest)
+{
+	if constexpr (std::is_trivially_copyable_v<T>)
+	{
+		const size_type count = static_cast<size_type>(last - first);
+
+		if (count > 0)
+		{
+			std::memcpy(static_cast<void*>(dest), first, count * sizeof(T));
+		}
+
+		return dest + count;
+	}
+	else if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>)
+	{
+		return std::uninitialized_move(first, last, dest);
+	}
+	else
+	{
+		return std::uninitialized_copy(first, last, dest);
+	}
+}
+
+template<typename T>
+inline void RingVector<T>::swap(RingVector<T>& other) noexcept
+{
+	std::swap(_container, other._container);
+	std::swap(_head, other._head);
+	std::swap(_size, other._size);
+	std::swap(_capacity, other._capacity);
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstddef>
+#include "VectorError.h"
+
+///////////////////////////////////////////////////////////////////////////////
+/// Span
+///
+/// Non-owning view of a contiguous run of elements, for handing parts of a
+/// container's storage to batch code. Stands in for std::span, which isn't
+/// available at the language level the project builds with.
+///
+template<typename T>
+class Span
+{
+public:
+	typedef                    std::size_t size_type;
+	typedef                    std::ptrdiff_t difference_type;
+
+	typedef                    T value_type;
+
+	typedef                    T* iterator;
+	typedef                    T& reference;
+	typedef                    T* pointer;
+
+public:
+	constexpr Span() noexcept;
+	constexpr Span(pointer data, size_type size) noexcept;
+
+public:
+	constexpr reference operator[](const size_type n) const noexcept;
+	reference at(const size_type n) const;
+
+	constexpr bool empty() const noexcept;
+	constexpr size_type size() const noexcept;
+	constexpr pointer data() const noexcept;
+
+	constexpr iterator begin() const noexcept;
+	constexpr iterator end() const noexcept;
+
+private:
+	pointer _data;
+	size_type _size;
+};
+
+template<typename T>
+constexpr Span<T>::Span() noexcept
+	:
+	_data(nullptr),
+	_size(0)
+{
+}
+
+template<typename T>
+constexpr Span<T>::Span(pointer data, size_type size) noexcept
+	:
+	_data(data),
+	_size(size)
+{
+}
+
+template<typename T>
+constexpr inline typename Span<T>::reference
+Span<T>::operator[](const size_type n) const noexcept
+{
+	return _data[n];
+}
+
+template<typename T>
+inline typename Span<T>::reference
+Span<T>::at(const size_type n) const
+{
+	if (n >= _size)
+	{
+		VectorErrorPolicy::raise(VectorError::OutOfRange, "Span::at -- out of range");
+	}
+
+	return _data[n];
+}
+
+template<typename T>
+constexpr inline bool Span<T>::empty() const noexcept
+{
+	return _size == 0;
+}
+
+template<typename T>
+constexpr inline typename Span<T>::size_type
+Span<T>::size() const noexcept
+{
+	return _size;
+}
+
+template<typename T>
+constexpr inline typename Span<T>::pointer
+Span<T>::data() const noexcept
+{
+	return _data;
+}
+
+template<typename T>
+constexpr inline typename Span<T>::iterator
+Span<T>::begin() const noexcept
+{
+	return _data;
+}
+
+template<typename T>
+constexpr inline typename Span<T>::iterator
+Span<T>::end() const noexcept
+{
+	return _data + _size;
+}
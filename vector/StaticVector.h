@@ -0,0 +1,683 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "VectorError.h"
+
+///////////////////////////////////////////////////////////////////////////////
+/// Overflow policies
+///
+/// Decide what a StaticVector does when an element is added to a full vector.
+///
+/// ThrowOnOverflow  - raises VectorError::Length through VectorErrorPolicy,
+///                    i.e. throws std::length_error unless exceptions are off.
+/// AssertOnOverflow - asserts in debug builds; overflowing a release build is
+///                    undefined behaviour, like an out of range operator[].
+/// ReturnOnOverflow - nothing is added and the call reports the failure:
+///                    push_back returns false, emplace_back returns nullptr,
+///                    insert and emplace return end().
+///
+struct ThrowOnOverflow
+{
+	static constexpr bool kReportsFailure = false;
+
+	[[noreturn]] static void overflow(const char* message)
+	{
+		VectorErrorPolicy::raise(VectorError::Length, message);
+	}
+};
+
+struct AssertOnOverflow
+{
+	static constexpr bool kReportsFailure = false;
+
+	static void overflow(const char* message) noexcept
+	{
+		(void)message;
+		assert(!"StaticVector -- capacity exceeded");
+	}
+};
+
+struct ReturnOnOverflow
+{
+	static constexpr bool kReportsFailure = true;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+/// static_vector_size_t
+///
+/// The smallest unsigned type able to count up to N elements.
+///
+template<std::size_t N>
+using static_vector_size_t =
+	std::conditional_t<N <= UINT8_MAX, std::uint8_t,
+	std::conditional_t<N <= UINT16_MAX, std::uint16_t,
+	std::conditional_t<N <= UINT32_MAX, std::uint32_t, std::uint64_t>>>;
+
+///////////////////////////////////////////////////////////////////////////////
+/// StaticVector
+///
+/// Fixed-capacity Vector that keeps up to N elements inline and never touches
+/// the allocator. The element count is stored in the smallest integer type
+/// that fits N (counter_type); the interface still takes and returns
+/// std::size_t so that arguments are range checked before any narrowing, and
+/// copies of trivially copyable elements only memcpy the
+/// live part of the storage.
+///
+template<typename T, std::size_t N, typename OverflowPolicy = ThrowOnOverflow>
+class StaticVector
+{
+	static_assert(N > 0, "StaticVector needs a capacity of at least one element");
+
+public:
+	typedef                    std::size_t size_type;
+	typedef                    static_vector_size_t<N> counter_type;
+	typedef                    std::ptrdiff_t difference_type;
+
+	typedef                    T value_type;
+
+	typedef                    T* iterator;
+	typedef const              T* const_iterator;
+
+	typedef                    T& reference;
+	typedef const              T& const_reference;
+
+	typedef                    T* pointer;
+	typedef const              T* const_pointer;
+
+	typedef std::conditional_t<OverflowPolicy::kReportsFailure, bool, void> push_back_result;
+	typedef std::conditional_t<OverflowPolicy::kReportsFailure, pointer, reference> emplace_back_result;
+
+public:
+	StaticVector() noexcept;
+	explicit StaticVector(size_type count);
+	StaticVector(const StaticVector& other);
+	StaticVector(StaticVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>);
+	StaticVector(std::initializer_list<T> ilist);
+	~StaticVector();
+	StaticVector& operator=(const StaticVector& other);
+	StaticVector& operator=(StaticVector&& other) noexcept(std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_assignable_v<T>);
+
+public:
+	template<class... Args>
+	emplace_back_result emplace_back(Args&& ... args);
+
+	push_back_result push_back(const T& element);
+	push_back_result push_back(T&& element);
+
+	void pop_back();
+
+	iterator insert(const_iterator pos, const T& value);
+	iterator insert(const_iterator pos, T&& value);
+
+	template<class... Args>
+	iterator emplace(const_iterator pos, Args&& ... args);
+
+	iterator erase(const_iterator pos);
+	iterator erase(const_iterator first, const_iterator last);
+
+	reference operator[](const size_type n) noexcept;
+	const_reference operator[](const size_type n) const noexcept;
+
+	reference at(const size_type n);
+	const_reference at(const size_type n) const;
+
+public:
+	bool validate() const noexcept;
+	bool empty() const noexcept;
+	bool full() const noexcept;
+	size_type size() const noexcept;
+	static constexpr size_type capacity() noexcept;
+	static constexpr size_type max_size() noexcept;
+	void clear() noexcept;
+
+public:
+	iterator                   begin() noexcept;
+	const_iterator             begin() const noexcept;
+	const_iterator             cbegin() const noexcept;
+
+	iterator                   end() noexcept;
+	const_iterator             end() const noexcept;
+	const_iterator             cend() const noexcept;
+
+	reference                  front();
+	const_reference            front() const;
+
+	reference                  back();
+	const_reference            back() const;
+
+	pointer                    data() noexcept;
+	const_pointer              data() const noexcept;
+
+private:
+	void copy_elements_from(const StaticVector& other);
+	template<class... Args>
+	iterator emplace_internal(const_iterator pos, Args&& ... args);
+
+private:
+	alignas(T) unsigned char _storage[N * sizeof(T)];
+	counter_type _size;
+};
+
+template<typename T, std::size_t N, typename OverflowPolicy>
+StaticVector<T, N, OverflowPolicy>::StaticVector() noexcept
+	:
+	_size(0)
+{
+}
+
+template<typename T, std::size_t N, typename OverflowPolicy>
+StaticVector<T, N, OverflowPolicy>::StaticVector(size_type count)
+	:
+	_size(0)
+{
+	if (count > N)
+	{
+		VectorErrorPolicy::raise(VectorError::Length, "StaticVector -- count exceeds capacity");
+	}
+
+	std::uninitialized_value_construct_n(data(), count);
+	_size = static_cast<counter_type>(count);
+}
+
+template<typename T, std::size_t N, typename OverflowPolicy>
+StaticVector<T, N, OverflowPolicy>::StaticVector(const StaticVector& other)
+	:
+	_size(0)
+{
+	copy_elements_from(other);
+}
+
+template<typename T, std::size_t N, typename OverflowPolicy>
+StaticVector<T, N, OverflowPolicy>::StaticVector(StaticVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+	:
+	_size(0)
+{
+	if constexpr (std::is_trivially_copyable_v<T>)
+	{
+		copy_elements_from(other);
+	}
+	else
+	{
+		std::uninitialized_move(other.begin(), other.end(), data());
+		_size = other._size;
+	}
+}
+
+template<typename T, std::size_t N, typename OverflowPolicy>
+StaticVector<T, N, OverflowPolicy>::StaticVector(std::initializer_list<T> ilist)
+	:
+	_size(0)
+{
+	if (ilist.size() > N)
+	{
+		VectorErrorPolicy::raise(VectorError::Length, "StaticVector -- initializer list exceeds capacity");
+	}
+
+	std::uninitialized_copy(ilist.begin(), ilist.end(), data());
+	_size = static_cast<counter_type>(ilist.size());
+}
+
+template<typename T, std::size_t N, typename OverflowPolicy>
+StaticVector<T, N, OverflowPolicy>::~StaticVector()
+{
+	clear();
+}
+
+template<typename T, std::size_t N, typename OverflowPolicy>
+StaticVector<T, N, OverflowPolicy>& StaticVector<T, N, OverflowPolicy>::operator=(const StaticVector& other)
+{
+	if (this == &other)
+	{
+		return *this;
+	}
+
+	if constexpr (std::is_trivially_copyable_v<T>)
+	{
+		copy_elements_from(other);
+	}
+	else
+	{
+		const size_type assignedCount = std::min(_size, other._size);
+
+		std::copy(other.begin(), other.begin() + assignedCount, begin());
+
+		if (other._size > _size)
+		{
+			std::uninitialized_copy(other.begin() + assignedCount, other.end(), end());
+		}
+		else
+		{
+			std::destroy(begin() + assignedCount, end());
+		}
+
+		_size = other._size;
+	}
+
+	return *this;
+}
+
+template<typename T, std::size_t N, typename OverflowPolicy>
+StaticVector<T, N, OverflowPolicy>& StaticVector<T, N, OverflowPolicy>::operator=(StaticVector&& other) noexcept(std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_assignable_v<T>)
+{
+	if (this == &other)
+	{
+		return *this;
+	}
+
+	if constexpr (std::is_trivially_copyable_v<T>)
+	{
+		copy_elements_from(other);
+	}
+	else
+	{
+		const size_type assignedCount = std::min(_size, other._size);
+
+		std::move(other.begin(), other.begin() + assignedCount, begin());
+
+		if (other._size > _size)
+		{
+			std::uninitialized_move(other.begin() + assignedCount, other.end(), end());
+		}
+		else
+		{
+			std::destroy(begin() + assignedCount, end());
+		}
+
+		_size = other._size;
+	}
+
+	return *this;
+}
+
+template<typename T, std::size_t N, typename OverflowPolicy>
+template<class... Args>
+typename StaticVector<T, N, OverflowPolicy>::emplace_back_result
+StaticVector<T, N, OverflowPolicy>::emplace_back(Args&& ... args)
+{
+	if (_size == N)
+	{
+		if constexpr (OverflowPolicy::kReportsFailure)
+		{
+			return nullptr;
+		}
+		else
+		{
+			OverflowPolicy::overflow("StaticVector::emplace_back -- capacity exceeded");
+		}
+	}
+
+	T* element = new(data() + _size) T(std::forward<Args>(args)...);
+	_size += 1;
+
+	if constexpr (OverflowPolicy::kReportsFailure)
+	{
+		return element;
+	}
+	else
+	{
+		return *element;
+	}
+}
+
+template<typename T, std::size_t N, typename OverflowPolicy>
+typename StaticVector<T, N, OverflowPolicy>::push_back_result
+StaticVector<T, N, OverflowPolicy>::push_back(const T& element)
+{
+	if constexpr (OverflowPolicy::kReportsFailure)
+	{
+		return emplace_back(element) != nullptr;
+	}
+	else
+	{
+		emplace_back(element);
+	}
+}
+
+template<typename T, std::size_t N, typename OverflowPolicy>
+typename StaticVector<T, N, OverflowPolicy>::push_back_result
+StaticVector<T, N, OverflowPolicy>::push_back(T&& element)
+{
+	if constexpr (OverflowPolicy::kReportsFailure)
+	{
+		return emplace_back(std::move(element)) != nullptr;
+	}
+	else
+	{
+		emplace_back(std::move(element));
+	}
+}
+
+template<typename T, std::size_t N, typename OverflowPolicy>
+void StaticVector<T, N, OverflowPolicy>::pop_back()
+{
+	if (empty())
+	{
+		VectorErrorPolicy::raise(VectorError::Range, "StaticVector::pop_back -- empty vector");
+	}
+
+	_size -= 1;
+	std::destroy_at(data() + _size);
+}
+
+template<typename T, std::size_t N, typename OverflowPolicy>
+typename StaticVector<T, N, OverflowPolicy>::iterator
+StaticVector<T, N, OverflowPolicy>::insert(const_iterator pos, const T& value)
+{
+	return emplace_internal(pos, value);
+}
+
+template<typename T, std::size_t N, typename OverflowPolicy>
+typename StaticVector<T, N, OverflowPolicy>::iterator
+StaticVector<T, N, OverflowPolicy>::insert(const_iterator pos, T&& value)
+{
+	return emplace_internal(pos, std::move(value));
+}
+
+template<typename T, std::size_t N, typename OverflowPolicy>
+template<class... Args>
+typename StaticVector<T, N, OverflowPolicy>::iterator
+StaticVector<T, N, OverflowPolicy>::emplace(const_iterator pos, Args&& ... args)
+{
+	return emplace_internal(pos, std::forward<Args>(args)...);
+}
+
+template<typename T, std::size_t N, typename OverflowPolicy>
+typename StaticVector<T, N, OverflowPolicy>::iterator
+StaticVector<T, N, OverflowPolicy>::erase(const_iterator pos)
+{
+	if (pos < begin() || pos >= end())
+	{
+		VectorErrorPolicy::raise(VectorError::OutOfRange, "StaticVector::erase -- out of range");
+	}
+
+	iterator position = begin() + std::distance(cbegin(), pos);
+
+	std::move(position + 1, end(), position);
+
+	_size -= 1;
+	std::destroy_at(data() + _size);
+
+	return position;
+}
+
+template<typename T, std::size_t N, typename OverflowPolicy>
+typename StaticVector<T, N, OverflowPolicy>::iterator
+StaticVector<T, N, OverflowPolicy>::erase(const_iterator first, const_iterator last)
+{
+	if (first > last || first < begin() || last > end())
+	{
+		VectorErrorPolicy::raise(VectorError::OutOfRange, "StaticVector::erase(first, last) -- out of range");
+	}
+
+	iterator position = begin() + std::distance(cbegin(), first);
+
+	if (first == last)
+	{
+		return position;
+	}
+
+	iterator newEnd = std::move(begin() + std::distance(cbegin(), last), end(), position);
+
+	std::destroy(newEnd, end());
+	_size = static_cast<counter_type>(newEnd - begin());
+
+	return position;
+}
+
+template<typename T, std::size_t N, typename OverflowPolicy>
+inline typename StaticVector<T, N, OverflowPolicy>::reference
+StaticVector<T, N, OverflowPolicy>::operator[](const size_type n) noexcept
+{
+	return data()[n];
+}
+
+template<typename T, std::size_t N, typename OverflowPolicy>
+inline typename StaticVector<T, N, OverflowPolicy>::const_reference
+StaticVector<T, N, OverflowPolicy>::operator[](const size_type n) const noexcept
+{
+	return data()[n];
+}
+
+template<typename T, std::size_t N, typename OverflowPolicy>
+typename StaticVector<T, N, OverflowPolicy>::reference
+StaticVector<T, N, OverflowPolicy>::at(const size_type n)
+{
+	if (n >= _size)
+	{
+		VectorErrorPolicy::raise(VectorError::OutOfRange, "StaticVector::at -- out of range");
+	}
+
+	return data()[n];
+}
+
+template<typename T, std::size_t N, typename OverflowPolicy>
+typename StaticVector<T, N, OverflowPolicy>::const_reference
+StaticVector<T, N, OverflowPolicy>::at(const size_type n) const
+{
+	if (n >= _size)
+	{
+		VectorErrorPolicy::raise(VectorError::OutOfRange, "StaticVector::at -- out of range");
+	}
+
+	return data()[n];
+}
+
+template<typename T, std::size_t N, typename OverflowPolicy>
+inline bool StaticVector<T, N, OverflowPolicy>::validate() const noexcept
+{
+	return _size <= N;
+}
+
+template<typename T, std::size_t N, typename OverflowPolicy>
+inline bool StaticVector<T, N, OverflowPolicy>::empty() const noexcept
+{
+	return _size == 0;
+}
+
+template<typename T, std::size_t N, typename OverflowPolicy>
+inline bool StaticVector<T, N, OverflowPolicy>::full() const noexcept
+{
+	return _size == N;
+}
+
+template<typename T, std::size_t N, typename OverflowPolicy>
+inline typename StaticVector<T, N, OverflowPolicy>::size_type
+StaticVector<T, N, OverflowPolicy>::size() const noexcept
+{
+	return _size;
+}
+
+template<typename T, std::size_t N, typename OverflowPolicy>
+constexpr typename StaticVector<T, N, OverflowPolicy>::size_type
+StaticVector<T, N, OverflowPolicy>::capacity() noexcept
+{
+	return N;
+}
+
+template<typename T, std::size_t N, typename OverflowPolicy>
+constexpr typename StaticVector<T, N, OverflowPolicy>::size_type
+StaticVector<T, N, OverflowPolicy>::max_size() noexcept
+{
+	return N;
+}
+
+template<typename T, std::size_t N, typename OverflowPolicy>
+void StaticVector<T, N, OverflowPolicy>::clear() noexcept
+{
+	if constexpr (!std::is_trivially_destructible_v<T>)
+	{
+		std::destroy(begin(), end());
+	}
+
+	_size = 0;
+}
+
+template<typename T, std::size_t N, typename OverflowPolicy>
+inline typename StaticVector<T, N, OverflowPolicy>::iterator
+StaticVector<T, N, OverflowPolicy>::begin() noexcept
+{
+	return data();
+}
+
+template<typename T, std::size_t N, typename OverflowPolicy>
+inline typename StaticVector<T, N, OverflowPolicy>::const_iterator
+StaticVector<T, N, OverflowPolicy>::begin() const noexcept
+{
+	return data();
+}
+
+template<typename T, std::size_t N, typename OverflowPolicy>
+inline typename StaticVector<T, N, OverflowPolicy>::const_iterator
+StaticVector<T, N, OverflowPolicy>::cbegin() const noexcept
+{
+	return data();
+}
+
+template<typename T, std::size_t N, typename OverflowPolicy>
+inline typename StaticVector<T, N, OverflowPolicy>::iterator
+StaticVector<T, N, OverflowPolicy>::end() noexcept
+{
+	return data() + _size;
+}
+
+template<typename T, std::size_t N, typename OverflowPolicy>
+inline typename StaticVector<T, N, OverflowPolicy>::const_iterator
+StaticVector<T, N, OverflowPolicy>::end() const noexcept
+{
+	return data() + _size;
+}
+
+template<typename T, std::size_t N, typename OverflowPolicy>
+inline typename StaticVector<T, N, OverflowPolicy>::const_iterator
+StaticVector<T, N, OverflowPolicy>::cend() const noexcept
+{
+	return data() + _size;
+}
+
+template<typename T, std::size_t N, typename OverflowPolicy>
+inline typename StaticVector<T, N, OverflowPolicy>::reference
+StaticVector<T, N, OverflowPolicy>::front()
+{
+	return const_cast<reference>(std::as_const(*this).front());
+}
+
+template<typename T, std::size_t N, typename OverflowPolicy>
+inline typename StaticVector<T, N, OverflowPolicy>::const_reference
+StaticVector<T, N, OverflowPolicy>::front() const
+{
+	if (empty())
+	{
+		VectorErrorPolicy::raise(VectorError::Range, "StaticVector::front -- empty vector");
+	}
+
+	return *begin();
+}
+
+template<typename T, std::size_t N, typename OverflowPolicy>
+inline typename StaticVector<T, N, OverflowPolicy>::reference
+StaticVector<T, N, OverflowPolicy>::back()
+{
+	return const_cast<reference>(std::as_const(*this).back());
+}
+
+template<typename T, std::size_t N, typename OverflowPolicy>
+inline typename StaticVector<T, N, OverflowPolicy>::const_reference
+StaticVector<T, N, OverflowPolicy>::back() const
+{
+	if (empty())
+	{
+		VectorErrorPolicy::raise(VectorError::Range, "StaticVector::back -- empty vector");
+	}
+
+	return *std::prev(end());
+}
+
+template<typename T, std::size_t N, typename OverflowPolicy>
+inline typename StaticVector<T, N, OverflowPolicy>::pointer
+StaticVector<T, N, OverflowPolicy>::data() noexcept
+{
+	return std::launder(reinterpret_cast<T*>(_storage));
+}
+
+template<typename T, std::size_t N, typename OverflowPolicy>
+inline typename StaticVector<T, N, OverflowPolicy>::const_pointer
+StaticVector<T, N, OverflowPolicy>::data() const noexcept
+{
+	return std::launder(reinterpret_cast<const T*>(_storage));
+}
+
+// Only valid on an empty vector, or on any vector when T is trivially copyable.
+template<typename T, std::size_t N, typename OverflowPolicy>
+void StaticVector<T, N, OverflowPolicy>::copy_elements_from(const StaticVector& other)
+{
+	if constexpr (std::is_trivially_copyable_v<T>)
+	{
+		std::memcpy(_storage, other._storage, other._size * sizeof(T));
+	}
+	else
+	{
+		std::uninitialized_copy(other.begin(), other.end(), data());
+	}
+
+	_size = other._size;
+}
+
+template<typename T, std::size_t N, typename OverflowPolicy>
+template<class... Args>
+typename StaticVector<T, N, OverflowPolicy>::iterator
+StaticVector<T, N, OverflowPolicy>::emplace_internal(const_iterator pos, Args&& ... args)
+{
+	if (pos < begin() || pos > end())
+	{
+		VectorErrorPolicy::raise(VectorError::OutOfRange, "StaticVector::insert -- out of range");
+	}
+
+	if (_size == N)
+	{
+		if constexpr (OverflowPolicy::kReportsFailure)
+		{
+			return end();
+		}
+		else
+		{
+			OverflowPolicy::overflow("StaticVector::insert -- capacity exceeded");
+		}
+	}
+
+	const difference_type positionIndex = std::distance(cbegin(), pos);
+	iterator position = begin() + positionIndex;
+
+	if (position == end())
+	{
+		new(end()) T(std::forward<Args>(args)...);
+		_size += 1;
+
+		return position;
+	}
+
+	// Built up front since the arguments may refer to an element that is about to be shifted.
+	T element(std::forward<Args>(args)...);
+
+	new(end()) T(std::move(back()));
+	_size += 1;
+
+	std::move_backward(position, end() - 2, end() - 1);
+
+	*position = std::move(element);
+
+	return position;
+}
+
+template<typename T, std::size_t N, typename OverflowPolicy>
+inline bool operator==(const StaticVector<T, N, OverflowPolicy>& a, const StaticVector<T, N, OverflowPolicy>& b)
+{
+	return ((a.size() == b.size()) && std::equal(a.begin(), a.end(), b.begin()));
+}
@@ -0,0 +1,180 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include "CowVector.h"
+#include "TestObject.h"
+
+TEST(CowVectorTests, GivenCopiedVector_BufferIsShared)
+{
+	CowVector<int> a = { 1, 2, 3 };
+	CowVector<int> b(a);
+
+	EXPECT_TRUE(a.shared());
+	EXPECT_EQ(a.use_count(), 2);
+	EXPECT_EQ(std::as_const(a).data(), std::as_const(b).data());
+	EXPECT_TRUE(a == b);
+}
+
+TEST(CowVectorTests, GivenTestObjectVector_CopyDoesNotCopyElements)
+{
+	CowVector<TestObject> a(100);
+	TestObject::Reset();
+
+	CowVector<TestObject> b(a);
+	CowVector<TestObject> c;
+	c = b;
+
+	EXPECT_EQ(TestObject::sTOCopyCtorCount, 0);
+	EXPECT_EQ(a.use_count(), 3);
+}
+
+TEST(CowVectorTests, GivenSharedVector_PushBackDetachesOnlyTheWriter)
+{
+	CowVector<int> a = { 1, 2, 3 };
+	CowVector<int> b(a);
+
+	b.push_back(4);
+
+	EXPECT_FALSE(a.shared());
+	EXPECT_FALSE(b.shared());
+	EXPECT_EQ(a.size(), 3);
+	EXPECT_EQ(b.size(), 4);
+	EXPECT_EQ(std::as_const(b)[3], 4);
+}
+
+TEST(CowVectorTests, GivenSharedVector_MutatingCallsDetach)
+{
+	CowVector<int> a = { 1, 2, 3 };
+
+	CowVector<int> b(a);
+	b[0] = 10;
+	EXPECT_EQ(std::as_const(a)[0], 1);
+
+	CowVector<int> c(a);
+	c.insert(c.cbegin() + 1, 20);
+	EXPECT_EQ(a.size(), 3);
+
+	CowVector<int> d(a);
+	d.erase(d.cbegin());
+	EXPECT_EQ(std::as_const(a)[0], 1);
+
+	CowVector<int> e(a);
+	e.data()[2] = 30;
+	EXPECT_EQ(std::as_const(a)[2], 3);
+	EXPECT_EQ(a.use_count(), 1);
+}
+
+TEST(CowVectorTests, GivenMutableReferenceHandedOut_LaterCopiesDontSeeWritesThroughIt)
+{
+	CowVector<int> a = { 1, 2, 3 };
+	int& first = a[0];
+	int* elements = a.data();
+
+	CowVector<int> b(a);
+	CowVector<int> c;
+	c = a;
+
+	first = 10;
+	elements[2] = 30;
+
+	EXPECT_FALSE(a.shared());
+	EXPECT_EQ(std::as_const(b)[0], 1);
+	EXPECT_EQ(std::as_const(c)[2], 3);
+	EXPECT_EQ(std::as_const(a)[0], 10);
+
+	CowVector<int> d(b);
+	EXPECT_TRUE(b.shared());
+}
+
+TEST(CowVectorTests, GivenReallocationAfterMutableReference_CopiesShareAgain)
+{
+	CowVector<int> a = { 1, 2, 3 };
+	a[0] = 10;
+
+	CowVector<int> b(a);
+	EXPECT_FALSE(a.shared());
+
+	a.reserve(a.capacity() * 2);
+
+	CowVector<int> c(a);
+	EXPECT_TRUE(a.shared());
+	EXPECT_EQ(std::as_const(c)[0], 10);
+}
+
+TEST(CowVectorTests, GivenEditor_CopiesShareOnlyAfterItIsGone)
+{
+	CowVector<int> a = { 1, 2, 3 };
+	CowVector<int> b(a);
+
+	{
+		CowVector<int>::editor elements = a.edit();
+		(*elements)[0] = 10;
+		elements->push_back(4);
+
+		CowVector<int> c(a);
+		EXPECT_FALSE(a.shared());
+		EXPECT_FALSE(c.shared());
+		EXPECT_EQ(std::as_const(b)[0], 1);
+	}
+
+	CowVector<int> d(a);
+	EXPECT_TRUE(a.shared());
+	EXPECT_EQ(d.size(), 4);
+	EXPECT_EQ(std::as_const(d)[0], 10);
+	EXPECT_EQ(b.size(), 3);
+}
+
+TEST(CowVectorTests, GivenEmptyVector_MutableIteratorsDontAllocate)
+{
+	CowVector<int> empty;
+
+	EXPECT_EQ(empty.begin(), nullptr);
+	EXPECT_EQ(empty.end(), nullptr);
+	EXPECT_EQ(empty.data(), nullptr);
+	EXPECT_EQ(empty.use_count(), 0);
+
+	for (int& value : empty)
+	{
+		value = 0;
+	}
+	EXPECT_EQ(empty.capacity(), 0);
+}
+
+TEST(CowVectorTests, GivenSharedVector_UnshareMakesAPrivateCopy)
+{
+	CowVector<int> a = { 1, 2, 3 };
+	CowVector<int> b(a);
+
+	b.unshare();
+
+	EXPECT_FALSE(a.shared());
+	EXPECT_NE(std::as_const(a).data(), std::as_const(b).data());
+	EXPECT_TRUE(a == b);
+}
+
+TEST(CowVectorTests, GivenCopiesReleasedOnOtherThreads_BufferIsFreedOnce)
+{
+	TestObject::Reset();
+	{
+		CowVector<TestObject> a(10);
+		std::thread threads[4];
+
+		for (auto& thread : threads)
+		{
+			thread = std::thread([copy = a]() mutable
+			{
+				for (int i = 0; i < 1000; ++i)
+				{
+					CowVector<TestObject> local(copy);
+				}
+			});
+		}
+
+		for (auto& thread : threads)
+		{
+			thread.join();
+		}
+
+		EXPECT_EQ(a.use_count(), 1);
+	}
+	EXPECT_TRUE(TestObject::IsClear());
+}
@@ -0,0 +1,174 @@
+#include <gtest/gtest.h>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "FlatMap.h"
+#include "TestObject.h"
+
+TEST(BranchlessLowerBoundTests, GivenSortedRange_MatchesStdLowerBound)
+{
+	const int values[] = { 1, 3, 3, 5, 8, 13, 21 };
+
+	for (int key = 0; key <= 22; ++key)
+	{
+		EXPECT_EQ(branchless_lower_bound(std::begin(values), std::end(values), key, std::less<int>()),
+			std::lower_bound(std::begin(values), std::end(values), key));
+	}
+
+	EXPECT_EQ(branchless_lower_bound(values, values, 1, std::less<int>()), values);
+}
+
+TEST(FlatSetTests, GivenUnsortedInsertions_ElementsAreSortedAndUnique)
+{
+	FlatSet<int> set;
+
+	EXPECT_TRUE(set.insert(5).second);
+	EXPECT_TRUE(set.insert(1).second);
+	EXPECT_TRUE(set.insert(3).second);
+	EXPECT_FALSE(set.insert(3).second);
+
+	const int expected[] = { 1, 3, 5 };
+	EXPECT_TRUE(std::equal(set.begin(), set.end(), std::begin(expected), std::end(expected)));
+	EXPECT_TRUE(set.contains(3));
+	EXPECT_FALSE(set.contains(4));
+	EXPECT_EQ(*set.lower_bound(4), 5);
+	EXPECT_EQ(*set.upper_bound(3), 5);
+}
+
+TEST(FlatSetTests, GivenBulkInsert_ResultIsSortedUniqueUnion)
+{
+	FlatSet<int> set = { 10, 20, 30 };
+	const int batch[] = { 25, 5, 20, 5, 35, 15 };
+
+	set.insert(std::begin(batch), std::end(batch));
+
+	const int expected[] = { 5, 10, 15, 20, 25, 30, 35 };
+	EXPECT_TRUE(std::equal(set.begin(), set.end(), std::begin(expected), std::end(expected)));
+}
+
+TEST(FlatSetTests, GivenThrowDuringBulkInsert_ElementsStaySortedAndUnchanged)
+{
+	Vector<int> elements = { 10, 20, 30 };
+	const int batch[] = { 7, 99, 3 };
+
+	auto throwingCompare = [](int a, int b)
+	{
+		if (a == 99 || b == 99)
+		{
+			throw std::runtime_error("compare");
+		}
+
+		return a < b;
+	};
+
+	EXPECT_THROW(flat_bulk_insert(elements, std::begin(batch), std::end(batch), throwingCompare), std::runtime_error);
+	const int expected[] = { 10, 20, 30 };
+	EXPECT_TRUE(std::equal(elements.begin(), elements.end(), std::begin(expected), std::end(expected)));
+
+	Vector<TestObject> objects = { TestObject(1), TestObject(2) };
+	const TestObject copies[] = { TestObject(0), TestObject(3, true) };
+	auto byValue = [](const TestObject& a, const TestObject& b) { return a.mX < b.mX; };
+
+	EXPECT_ANY_THROW(flat_bulk_insert(objects, std::begin(copies), std::end(copies), byValue));
+	EXPECT_EQ(objects.size(), 2);
+	EXPECT_EQ(objects[1].mX, 2);
+}
+
+TEST(FlatSetTests, GivenErase_KeyIsRemoved)
+{
+	FlatSet<int> set = { 1, 2, 3 };
+
+	EXPECT_EQ(set.erase(2), 1);
+	EXPECT_EQ(set.erase(2), 0);
+	EXPECT_EQ(set.size(), 2);
+
+	set.clear();
+	EXPECT_TRUE(set.empty());
+}
+
+TEST(FlatMapTests, GivenInsertions_LookupFindsValues)
+{
+	FlatMap<int, std::string> map;
+
+	map[3] = "three";
+	map.insert({ 1, "one" });
+	map.try_emplace(2, "two");
+
+	EXPECT_FALSE(map.insert({ 1, "uno" }).second);
+	EXPECT_EQ(map.at(1), "one");
+	EXPECT_EQ(map.at(2), "two");
+	EXPECT_EQ(map[3], "three");
+	EXPECT_EQ(map.begin()->first, 1);
+	EXPECT_EQ(map.find(4), map.end());
+	EXPECT_THROW(map.at(4), std::out_of_range);
+}
+
+TEST(FlatMapTests, GivenInsertOrAssign_ExistingValueIsReplaced)
+{
+	FlatMap<int, std::string> map = { { 1, "one" } };
+
+	EXPECT_FALSE(map.insert_or_assign(1, "uno").second);
+	EXPECT_TRUE(map.insert_or_assign(2, "dos").second);
+	EXPECT_EQ(map.at(1), "uno");
+	EXPECT_EQ(map.size(), 2);
+}
+
+TEST(FlatMapTests, GivenBulkInsert_ExistingAndEarlierKeysWin)
+{
+	FlatMap<int, std::string> map = { { 2, "two" } };
+	const std::pair<int, std::string> batch[] = { { 3, "three" }, { 2, "deux" }, { 1, "one" }, { 3, "trois" } };
+
+	map.insert(std::begin(batch), std::end(batch));
+
+	ASSERT_EQ(map.size(), 3);
+	EXPECT_EQ(map.at(1), "one");
+	EXPECT_EQ(map.at(2), "two");
+	EXPECT_EQ(map.at(3), "three");
+}
+
+TEST(FlatMapTests, GivenRandomOperations_BehavesLikeStdMap)
+{
+	std::mt19937 random(42);
+	std::uniform_int_distribution<int> keys(0, 500);
+	FlatMap<int, int> flat;
+	std::map<int, int> reference;
+
+	for (int round = 0; round < 20; ++round)
+	{
+		std::vector<std::pair<int, int>> batch;
+
+		for (int i = 0; i < 50; ++i)
+		{
+			batch.emplace_back(keys(random), i);
+		}
+
+		flat.insert(batch.begin(), batch.end());
+		reference.insert(batch.begin(), batch.end());
+
+		const int erased = keys(random);
+		EXPECT_EQ(flat.erase(erased), reference.erase(erased));
+	}
+
+	ASSERT_EQ(flat.size(), reference.size());
+	EXPECT_TRUE(std::equal(flat.begin(), flat.end(), reference.begin(), [](const auto& a, const auto& b)
+	{
+		return a.first == b.first && a.second == b.second;
+	}));
+}
+
+TEST(FlatMapTests, GivenTestObjectValues_BulkInsertDestroysDuplicates)
+{
+	TestObject::Reset();
+	{
+		FlatMap<int, TestObject> map;
+		const std::pair<int, TestObject> batch[] = { { 1, TestObject(1) }, { 1, TestObject(2) }, { 0, TestObject(3) } };
+
+		map.insert(std::begin(batch), std::end(batch));
+
+		EXPECT_EQ(map.size(), 2);
+		EXPECT_EQ(map.at(1).mX, 1);
+	}
+	EXPECT_TRUE(TestObject::IsClear());
+}
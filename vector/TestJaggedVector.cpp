@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include <list>
+#include "JaggedVector.h"
+#include "TestObject.h"
+
+TEST(JaggedVectorTests, GivenAppendedRows_RowsReturnTheirValues)
+{
+	JaggedVector<int> jagged;
+
+	jagged.append_row({ 1, 2, 3 });
+	jagged.append_empty_row();
+	jagged.append_row(std::list<int>{ 4, 5 });
+
+	ASSERT_EQ(jagged.row_count(), 3);
+	EXPECT_EQ(jagged.value_count(), 5);
+	EXPECT_EQ(jagged.row(0).size(), 3);
+	EXPECT_TRUE(jagged.row(1).empty());
+	EXPECT_EQ(jagged.row(2)[1], 5);
+	EXPECT_THROW(jagged.at(3), std::out_of_range);
+}
+
+TEST(JaggedVectorTests, GivenRows_ValuesAreContiguous)
+{
+	JaggedVector<int> jagged;
+	jagged.append_row({ 1, 2 });
+	jagged.append_row({ 3 });
+
+	const Span<const int> values = std::as_const(jagged).values();
+
+	EXPECT_EQ(jagged.row(1).data(), values.data() + 2);
+	const int expected[] = { 1, 2, 3 };
+	EXPECT_TRUE(std::equal(values.begin(), values.end(), std::begin(expected), std::end(expected)));
+}
+
+TEST(JaggedVectorTests, GivenLastRow_PushBackGrowsOnlyThatRow)
+{
+	JaggedVector<int> jagged;
+	EXPECT_THROW(jagged.push_back_to_last_row(1), std::range_error);
+
+	jagged.append_row({ 1 });
+	jagged.append_row({ 2 });
+	jagged.push_back_to_last_row(3);
+
+	EXPECT_EQ(jagged.row(0).size(), 1);
+	ASSERT_EQ(jagged.row(1).size(), 2);
+	EXPECT_EQ(jagged.row(1)[1], 3);
+}
+
+TEST(JaggedVectorTests, GivenNestedVector_FromNestedCopiesEveryRow)
+{
+	Vector<Vector<int>> nested;
+	nested.push_back({ 1, 2 });
+	nested.push_back({});
+	nested.push_back({ 3, 4, 5 });
+
+	const JaggedVector<int> jagged = JaggedVector<int>::from_nested(nested);
+
+	ASSERT_EQ(jagged.row_count(), nested.size());
+	for (std::size_t i = 0; i < nested.size(); ++i)
+	{
+		const Span<const int> row = jagged.row(i);
+		EXPECT_TRUE(std::equal(row.begin(), row.end(), nested[i].begin(), nested[i].end()));
+	}
+}
+
+TEST(JaggedVectorTests, GivenThrowingCopy_AppendRowLeavesPreviousRowsIntact)
+{
+	JaggedVector<TestObject> jagged;
+	jagged.append_row({ TestObject(1) });
+
+	const TestObject row[] = { TestObject(2), TestObject(3, true) };
+	EXPECT_ANY_THROW(jagged.append_row(row));
+
+	EXPECT_EQ(jagged.row_count(), 1);
+	EXPECT_EQ(jagged.value_count(), 1);
+
+	jagged.append_row({ TestObject(4) });
+	EXPECT_EQ(jagged.row(1)[0].mX, 4);
+}
+
+TEST(JaggedVectorTests, GivenRowByRowAppends_AllocationsGrowLogarithmically)
+{
+	static int allocations = 0;
+	allocations = 0;
+	VectorAllocationHooks::onAllocate = [](void*, std::size_t) { allocations += 1; };
+
+	JaggedVector<int> jagged;
+	for (int i = 0; i < 10000; ++i)
+	{
+		jagged.append_row({ i, i + 1, i + 2 });
+	}
+
+	VectorAllocationHooks::onAllocate = nullptr;
+
+	EXPECT_EQ(jagged.value_count(), 30000);
+	EXPECT_EQ(jagged.row(9999)[2], 10001);
+	EXPECT_LT(allocations, 100);
+}
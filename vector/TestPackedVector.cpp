@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include "PackedVector.h"
+
+namespace
+{
+	template<typename Int>
+	void ExpectSameValues(const PackedVector<Int>& packed, const Vector<Int>& expected)
+	{
+		ASSERT_EQ(packed.size(), expected.size());
+
+		for (std::size_t i = 0; i < expected.size(); ++i)
+		{
+			ASSERT_EQ(packed[i], expected[i]) << "at index " << i;
+		}
+
+		std::size_t index = 0;
+		packed.for_each([&](Int value)
+		{
+			EXPECT_EQ(value, expected[index]);
+			index += 1;
+		});
+		EXPECT_EQ(index, expected.size());
+	}
+}
+
+TEST(PackedVectorTests, GivenSmallValues_RandomAccessAndScanReturnThem)
+{
+	std::mt19937_64 random(7);
+	std::uniform_int_distribution<std::uint64_t> distribution(1000, 1000 + 255);
+
+	PackedVector<std::uint64_t> packed;
+	Vector<std::uint64_t> expected;
+
+	for (int i = 0; i < 1000; ++i)
+	{
+		expected.push_back(distribution(random));
+		packed.push_back(expected.back());
+	}
+
+	ExpectSameValues(packed, expected);
+	EXPECT_EQ(packed.block_count(), 8);
+	EXPECT_THROW(packed.at(1000), std::out_of_range);
+}
+
+TEST(PackedVectorTests, GivenSortedValues_DeltaPacksTighterThanFrameOfReference)
+{
+	PackedVector<std::uint64_t> frameOfReference(PackedEncoding::FrameOfReference);
+	PackedVector<std::uint64_t> delta(PackedEncoding::Delta);
+	Vector<std::uint64_t> expected;
+
+	for (std::uint64_t i = 0; i < 100000; ++i)
+	{
+		expected.push_back(1'000'000'000 + i * 1000 + i % 7);
+		frameOfReference.push_back(expected.back());
+		delta.push_back(expected.back());
+	}
+
+	ExpectSameValues(frameOfReference, expected);
+	ExpectSameValues(delta, expected);
+
+	const std::size_t rawBytes = expected.size() * sizeof(std::uint64_t);
+	EXPECT_LT(frameOfReference.memory_bytes() * 2, rawBytes);
+	EXPECT_LT(delta.memory_bytes() * 6, rawBytes);
+}
+
+TEST(PackedVectorTests, GivenUnsortedBlocks_DeltaFallsBackToFrameOfReference)
+{
+	PackedVector<std::uint32_t> packed(PackedEncoding::Delta);
+	Vector<std::uint32_t> expected;
+
+	for (std::uint32_t i = 0; i < 1000; ++i)
+	{
+		expected.push_back(i % 2 == 0 ? 500 + i : 500 - i / 4);
+		packed.push_back(expected.back());
+	}
+
+	ExpectSameValues(packed, expected);
+}
+
+TEST(PackedVectorTests, GivenSignedValues_NegativeValuesRoundTrip)
+{
+	PackedVector<std::int32_t> packed;
+	Vector<std::int32_t> expected;
+
+	for (std::int32_t i = -700; i < 700; ++i)
+	{
+		expected.push_back(i * 3);
+		packed.push_back(expected.back());
+	}
+
+	ExpectSameValues(packed, expected);
+}
+
+TEST(PackedVectorTests, GivenFullRangeValues_EveryBitWidthRoundTrips)
+{
+	PackedVector<std::int64_t> packed;
+	Vector<std::int64_t> expected;
+	std::mt19937_64 random(11);
+
+	// One block per bit width, the last one spanning the full 64-bit range.
+	for (unsigned bitWidth = 0; bitWidth <= 64; ++bitWidth)
+	{
+		const std::uint64_t mask = bitWidth == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << bitWidth) - 1;
+
+		for (std::size_t i = 0; i < PackedVector<std::int64_t>::kBlockSize; ++i)
+		{
+			expected.push_back(static_cast<std::int64_t>(random() & mask) - 5);
+			packed.push_back(expected.back());
+		}
+	}
+
+	expected.push_back(std::numeric_limits<std::int64_t>::min());
+	packed.push_back(expected.back());
+
+	ExpectSameValues(packed, expected);
+
+	Vector<std::int64_t> block(PackedVector<std::int64_t>::kBlockSize);
+	EXPECT_EQ(packed.decode_block(packed.block_count() - 1, block.data()), 1);
+	EXPECT_EQ(block[0], std::numeric_limits<std::int64_t>::min());
+}
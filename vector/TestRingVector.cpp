@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include "RingVector.h"
+#include "TestObject.h"
+
+TEST(RingVectorTests, GivenFifoUsage_ElementsComeOutInOrder)
+{
+	RingVector<int> ring;
+
+	for (int i = 0; i < 100; ++i)
+	{
+		ring.push_back(i);
+
+		if (i % 3 == 0)
+		{
+			ring.pop_front();
+		}
+	}
+
+	int expected = 34;
+	while (!ring.empty())
+	{
+		EXPECT_EQ(ring.front(), expected++);
+		ring.pop_front();
+	}
+
+	EXPECT_EQ(expected, 100);
+}
+
+TEST(RingVectorTests, GivenPushes_CapacityIsAPowerOfTwo)
+{
+	RingVector<int> ring;
+	ring.reserve(5);
+	EXPECT_EQ(ring.capacity(), 8);
+
+	for (int i = 0; i < 9; ++i)
+	{
+		ring.push_back(i);
+	}
+
+	EXPECT_EQ(ring.capacity(), 16);
+}
+
+TEST(RingVectorTests, GivenCapacityPastMaxSize_ReserveThrowsInsteadOfOverflowing)
+{
+	RingVector<int> ring;
+
+	EXPECT_THROW(ring.reserve(RingVector<int>::max_size() + 1), std::length_error);
+	EXPECT_THROW(ring.reserve(std::numeric_limits<std::size_t>::max()), std::length_error);
+	EXPECT_EQ(ring.capacity(), 0);
+
+	const std::size_t maxSize = RingVector<int>::max_size();
+	EXPECT_EQ(maxSize & (maxSize - 1), 0);
+	EXPECT_LE(maxSize, Vector<int>::max_size());
+}
+
+TEST(RingVectorTests, GivenPushFront_ElementsArePrepended)
+{
+	RingVector<int> ring = { 3, 4 };
+
+	ring.push_front(2);
+	ring.push_front(1);
+	ring.push_back(5);
+
+	for (int i = 0; i < 5; ++i)
+	{
+		EXPECT_EQ(ring[i], i + 1);
+	}
+
+	ring.pop_back();
+	EXPECT_EQ(ring.back(), 4);
+	EXPECT_THROW(ring.at(4), std::out_of_range);
+}
+
+TEST(RingVectorTests, GivenWrappedRing_AsSpansReturnsBothHalvesInOrder)
+{
+	RingVector<int> ring;
+	ring.reserve(8);
+
+	for (int i = 0; i < 8; ++i)
+	{
+		ring.push_back(i);
+	}
+
+	ring.pop_front();
+	ring.pop_front();
+	ring.push_back(8);
+
+	const RingVector<int>::span_pair halves = ring.as_spans();
+	EXPECT_EQ(halves.first.size(), 6);
+	EXPECT_EQ(halves.second.size(), 1);
+	EXPECT_EQ(halves.first[0], 2);
+	EXPECT_EQ(halves.second[0], 8);
+}
+
+TEST(RingVectorTests, GivenWrappedRing_GrowthLinearizesTheElements)
+{
+	RingVector<int> ring;
+	ring.reserve(4);
+
+	for (int i = 0; i < 4; ++i)
+	{
+		ring.push_back(i);
+	}
+
+	ring.pop_front();
+	ring.push_back(4);
+	ring.push_back(5);
+
+	const RingVector<int>::span_pair halves = ring.as_spans();
+	EXPECT_EQ(halves.second.size(), 0);
+	ASSERT_EQ(halves.first.size(), 5);
+
+	for (int i = 0; i < 5; ++i)
+	{
+		EXPECT_EQ(halves.first[i], i + 1);
+	}
+}
+
+TEST(RingVectorTests, GivenFullRing_PushingAnOwnElementIsSafe)
+{
+	RingVector<std::string> ring = { "a", "b" };
+
+	ring.push_back(ring.front());
+
+	EXPECT_EQ(ring.back(), "a");
+}
+
+TEST(RingVectorTests, GivenTestObjects_CopyMoveAndDestructionBalance)
+{
+	TestObject::Reset();
+	{
+		RingVector<TestObject> ring;
+
+		for (int i = 0; i < 20; ++i)
+		{
+			ring.emplace_back(i);
+			ring.emplace_front(-i);
+			ring.pop_back();
+		}
+
+		RingVector<TestObject> copy(ring);
+		RingVector<TestObject> moved(std::move(copy));
+
+		EXPECT_EQ(moved.size(), 20);
+		EXPECT_EQ(moved.front().mX, -19);
+		EXPECT_TRUE(copy.empty());
+	}
+	EXPECT_TRUE(TestObject::IsClear());
+}
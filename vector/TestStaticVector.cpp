@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+#include <string>
+#include "StaticVector.h"
+#include "TestObject.h"
+
+TEST(StaticVectorTests, GivenCapacity_CounterTypeIsTheSmallestThatFits)
+{
+	static_assert(std::is_same_v<StaticVector<int, 16>::counter_type, std::uint8_t>);
+	static_assert(std::is_same_v<StaticVector<int, 255>::counter_type, std::uint8_t>);
+	static_assert(std::is_same_v<StaticVector<int, 256>::counter_type, std::uint16_t>);
+	static_assert(std::is_same_v<StaticVector<char, 70000>::counter_type, std::uint32_t>);
+	static_assert(std::is_same_v<StaticVector<int, 16>::size_type, std::size_t>);
+	static_assert(sizeof(StaticVector<char, 15>) == 16);
+	static_assert(StaticVector<int, 16>::capacity() == 16);
+}
+
+TEST(StaticVectorTests, GivenNonEmptyVector_ElementsAreAtCorrectPosition)
+{
+	StaticVector<int, 8> v;
+
+	v.push_back(1);
+	v.push_back(3);
+	v.emplace_back(4);
+	v.insert(v.begin() + 1, 2);
+	v.emplace(v.begin(), 0);
+
+	EXPECT_TRUE(v.validate());
+	EXPECT_EQ(v.size(), 5);
+	for (int i = 0; i < 5; ++i)
+	{
+		EXPECT_EQ(v[i], i);
+	}
+
+	v.erase(v.begin());
+	v.erase(v.begin() + 1, v.begin() + 3);
+	EXPECT_EQ(v.size(), 2);
+	EXPECT_EQ(v.front(), 1);
+	EXPECT_EQ(v.back(), 4);
+	EXPECT_THROW(v.at(2), std::out_of_range);
+}
+
+TEST(StaticVectorTests, GivenThrowPolicy_OverflowThrowsAndKeepsTheElements)
+{
+	StaticVector<int, 2> v = { 1, 2 };
+
+	EXPECT_THROW(v.push_back(3), std::length_error);
+	EXPECT_THROW(v.insert(v.begin(), 0), std::length_error);
+	EXPECT_EQ(v.size(), 2);
+	EXPECT_EQ(v[1], 2);
+}
+
+TEST(StaticVectorTests, GivenReturnPolicy_OverflowReportsFailure)
+{
+	StaticVector<int, 2, ReturnOnOverflow> v;
+
+	EXPECT_TRUE(v.push_back(1));
+	EXPECT_NE(v.emplace_back(2), nullptr);
+	EXPECT_FALSE(v.push_back(3));
+	EXPECT_EQ(v.emplace_back(4), nullptr);
+	EXPECT_EQ(v.insert(v.begin(), 0), v.end());
+	EXPECT_EQ(v.size(), 2);
+	EXPECT_TRUE(v.full());
+}
+
+TEST(StaticVectorTests, GivenTrivialElements_CopyCopiesTheLiveElements)
+{
+	StaticVector<int, 64> a = { 1, 2, 3 };
+	StaticVector<int, 64> b(a);
+	StaticVector<int, 64> c;
+	c = b;
+
+	EXPECT_TRUE(a == b);
+	EXPECT_TRUE(b == c);
+	EXPECT_EQ(c.size(), 3);
+}
+
+TEST(StaticVectorTests, GivenTestObjectVector_EveryElementIsDestroyed)
+{
+	TestObject::Reset();
+	{
+		StaticVector<TestObject, 16> a;
+		for (int i = 0; i < 10; ++i)
+		{
+			a.emplace_back(i);
+		}
+
+		a.insert(a.begin() + 3, TestObject(42));
+		a.erase(a.begin());
+		a.pop_back();
+
+		StaticVector<TestObject, 16> b(a);
+		StaticVector<TestObject, 16> c;
+		c = b;
+		c = std::move(a);
+
+		EXPECT_EQ(c.size(), 9);
+		EXPECT_EQ(c[2].mX, 42);
+	}
+	EXPECT_TRUE(TestObject::IsClear());
+}
+
+TEST(StaticVectorTests, GivenStringElements_InsertShiftsThemCorrectly)
+{
+	StaticVector<std::string, 4> v = { "a", "c" };
+
+	v.insert(v.begin() + 1, "b");
+	v.insert(v.begin(), v[2]);
+
+	EXPECT_EQ(v[0], "c");
+	EXPECT_EQ(v[1], "a");
+	EXPECT_EQ(v[2], "b");
+	EXPECT_EQ(v[3], "c");
+}
+
+TEST(StaticVectorTests, GivenIndexWiderThanCounter_AtAndCountAreCheckedBeforeNarrowing)
+{
+	StaticVector<int, 100> v{ 1, 2, 3 };
+
+	EXPECT_THROW(v.at(std::size_t(256)), std::out_of_range);
+	EXPECT_THROW(std::as_const(v).at(std::size_t(257)), std::out_of_range);
+	EXPECT_THROW((StaticVector<int, 100>(std::size_t(300))), std::length_error);
+}
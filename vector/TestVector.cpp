@@ -1,5 +1,13 @@
 #include <gtest/gtest.h>
+#include <list>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <iterator>
 #include "Vector.h"
+#include "VectorBufferPool.h"
+#include "VectorReclaimer.h"
 #include "TestObject.h"
 #include <cstdarg>
 
@@ -158,6 +166,7 @@ bool VerifySequence(InputIterator first, InputIterator last, StackValue /*unused
 template Vector<bool>;
 template Vector<int>;
 template class Vector<TestObject>;
+template class Vector<int, std::size_t, VectorCustomDeleter>;
 
 struct AddressOfOperatorResult {};
 struct HasAddressOfOperator
@@ -793,8 +802,9 @@ TEST(InsertTest, GivenNonEmptyArray_InsertEmplacesElementAtTheRightPosition)
 	toVectorC.insert(toVectorC.begin(), TestObject(3, 4, 5));
 	EXPECT_EQ(toVectorC.size(), 2);
 	EXPECT_EQ(toVectorC.front().mX, (3 + 4 + 5));
-	EXPECT_EQ(TestObject::sTOMoveCtorCount, 3);				// 3 because the original count of 1, plus the existing
-															// vector element will be moved, plus the one being emplaced.
+	EXPECT_EQ(TestObject::sTOMoveCtorCount, 2);				// 2 because the original count of 1, plus the one being emplaced.
+	EXPECT_EQ(TestObject::sTOCopyCtorCount, 1);				// TestObject's move assignment may throw, so the existing
+															// vector element is copied one slot further instead of moved.
 }
 
 TEST(InsertTest, GivenNonEmptyArray_InsertingAtTheEndWorks)
@@ -891,3 +901,1084 @@ TEST(InsertTest, GivenNonEmptyUniqueVector_InsertKeepsTheElement)
 	v.insert(v.begin(), 19);
 	EXPECT_TRUE(VerifySequence(v.begin(), v.end(), int(), "vector.insert", 19, 19, 19, 99, 0, 1, 2, 3, 4, -1));
 }
+
+TEST(CopyAssignmentTests, GivenVectorWithEnoughCapacity_CopyAssignmentReusesTheBuffer)
+{
+	Vector<int> source = { 1, 2, 3, 4, 5 };
+	Vector<int> destination;
+	destination.reserve(16);
+	const int* buffer = destination.data();
+
+	destination = source;
+
+	EXPECT_EQ(destination.data(), buffer);
+	EXPECT_EQ(destination.capacity(), 16);
+	EXPECT_TRUE(VerifySequence(destination.begin(), destination.end(), int(), "vector=(const vector&)", 1, 2, 3, 4, 5, -1));
+}
+
+TEST(CopyAssignmentTests, GivenNothrowCopyableElements_SurplusElementsAreDestroyed)
+{
+	auto shared = std::make_shared<int>(7);
+	Vector<std::shared_ptr<int>> source;
+	Vector<std::shared_ptr<int>> destination;
+
+	for (int i = 0; i < 8; ++i)
+	{
+		destination.push_back(shared);
+	}
+
+	source.push_back(shared);
+	source.push_back(shared);
+
+	const std::shared_ptr<int>* buffer = destination.data();
+	destination = source;
+
+	EXPECT_EQ(destination.data(), buffer);
+	EXPECT_EQ(destination.size(), 2);
+	EXPECT_EQ(shared.use_count(), 5);
+
+	source.push_back(shared);
+	source.push_back(shared);
+	source.push_back(shared);
+	destination = source;
+
+	EXPECT_EQ(destination.data(), buffer);
+	EXPECT_EQ(destination.size(), 5);
+	EXPECT_EQ(shared.use_count(), 11);
+}
+
+TEST(CopyAssignmentTests, GivenThrowingCopy_CopyAssignmentKeepsTheOriginalElements)
+{
+	Vector<TestObject> source;
+	source.push_back(TestObject(1));
+	source.push_back(TestObject(2, false));
+	source.back().mbThrowOnCopy = true;
+
+	Vector<TestObject> destination;
+	destination.reserve(8);
+	destination.push_back(TestObject(42));
+
+	EXPECT_ANY_THROW(destination = source);
+	EXPECT_EQ(destination.size(), 1);
+	EXPECT_EQ(destination.front().mX, 42);
+}
+
+TEST(InsertTest, GivenThrowingMoveAssignment_MiddleInsertDoesNotCopyTheWholeVector)
+{
+	Vector<TestObject> toVector;
+	toVector.reserve(64);
+
+	for (int i = 0; i < 32; ++i)
+	{
+		toVector.emplace_back(i);
+	}
+
+	TestObject::Reset();
+
+	toVector.insert(toVector.begin() + 30, TestObject(99));
+
+	EXPECT_EQ(toVector.size(), 33);
+	EXPECT_EQ(toVector[30].mX, 99);
+	EXPECT_EQ(toVector[31].mX, 30);
+	EXPECT_EQ(toVector[32].mX, 31);
+	EXPECT_LE(TestObject::sTOCopyCtorCount + TestObject::sTOCopyAssignCount, 3);
+}
+
+TEST(InsertTest, GivenThrowingCopyDuringShift_InsertLeavesTheVectorUnchanged)
+{
+	Vector<TestObject> toVector;
+	toVector.reserve(16);
+
+	for (int i = 0; i < 6; ++i)
+	{
+		toVector.emplace_back(i);
+	}
+
+	toVector[2].mbThrowOnCopy = true;
+
+	EXPECT_ANY_THROW(toVector.insert(toVector.begin() + 1, TestObject(99)));
+
+	EXPECT_EQ(toVector.size(), 6);
+	for (int i = 0; i < 6; ++i)
+	{
+		EXPECT_EQ(toVector[i].mX, i);
+	}
+}
+
+TEST(InsertTest, GivenThrowingCopyDuringReallocation_InsertLeavesTheVectorUnchanged)
+{
+	Vector<TestObject> toVector;
+	toVector.reserve(4);
+
+	for (int i = 0; i < 4; ++i)
+	{
+		toVector.emplace_back(i);
+	}
+
+	toVector[3].mbThrowOnCopy = true;
+	const TestObject* buffer = toVector.data();
+
+	EXPECT_ANY_THROW(toVector.insert(toVector.begin() + 1, TestObject(99)));
+
+	EXPECT_EQ(toVector.data(), buffer);
+	EXPECT_EQ(toVector.size(), 4);
+	EXPECT_EQ(toVector.capacity(), 4);
+	EXPECT_EQ(toVector[1].mX, 1);
+}
+
+TEST(EmplaceTests, GivenTestObjectVector_EmplaceConstructsInPlace)
+{
+	Vector<TestObject> toVector;
+	toVector.reserve(4);
+	toVector.emplace_back(1);
+	toVector.emplace_back(3);
+
+	auto it = toVector.emplace(toVector.begin() + 1, 2, 0, 0);
+
+	EXPECT_EQ(it, toVector.begin() + 1);
+	EXPECT_EQ(it->mX, 2);
+	EXPECT_EQ(toVector.size(), 3);
+	EXPECT_EQ(toVector.back().mX, 3);
+}
+
+TEST(EmplaceTests, GivenFullVector_EmplaceRelocatesEveryElementExactlyOnce)
+{
+	Vector<TestObject> toVector;
+	toVector.reserve(8);
+
+	for (int i = 0; i < 8; ++i)
+	{
+		toVector.emplace_back(i);
+	}
+
+	TestObject::Reset();
+
+	auto it = toVector.emplace(toVector.begin() + 3, 99);
+
+	EXPECT_EQ(TestObject::sTOCopyCtorCount + TestObject::sTOMoveCtorCount, 8);
+	EXPECT_EQ(TestObject::sTOCopyAssignCount + TestObject::sTOMoveAssignCount, 0);
+	EXPECT_EQ(TestObject::sTODefaultCtorCount, 1);
+	EXPECT_EQ(it, toVector.begin() + 3);
+	EXPECT_EQ(it->mX, 99);
+	EXPECT_EQ(toVector[2].mX, 2);
+	EXPECT_EQ(toVector[4].mX, 3);
+	EXPECT_EQ(toVector.back().mX, 7);
+}
+
+TEST(EmplaceTests, GivenFullVector_InsertReturnsAnIteratorIntoTheNewBuffer)
+{
+	Vector<int> v = { 1, 2, 4 };
+
+	auto it = v.insert(v.begin() + 2, 3);
+
+	EXPECT_EQ(it, v.begin() + 2);
+	EXPECT_EQ(*it, 3);
+	EXPECT_TRUE(VerifySequence(v.begin(), v.end(), int(), "vector.insert", 1, 2, 3, 4, -1));
+}
+
+TEST(EmplaceTests, GivenElementOfTheSameVector_InsertCopiesItBeforeShifting)
+{
+	Vector<std::string> v;
+	v.reserve(8);
+	v.push_back("a");
+	v.push_back("b");
+	v.push_back("c");
+
+	v.insert(v.begin(), v[1]);
+
+	EXPECT_EQ(v[0], "b");
+	EXPECT_EQ(v[1], "a");
+	EXPECT_EQ(v[2], "b");
+	EXPECT_EQ(v[3], "c");
+}
+
+TEST(EmplaceBackTests, GivenLvalueArgument_EmplaceBackDoesNotMoveFromIt)
+{
+	Vector<std::string> v;
+	std::string value = "payload";
+
+	v.emplace_back(value);
+
+	EXPECT_EQ(value, "payload");
+	EXPECT_EQ(v.back(), "payload");
+}
+
+#if VECTOR_HAS_CONSTEXPR_ALLOCATION
+constexpr int SumOfSquares(int count)
+{
+	Vector<int> squares;
+
+	for (int i = 0; i < count; ++i)
+	{
+		squares.push_back(i * i);
+	}
+
+	squares.insert(squares.begin(), 100);
+	squares.erase(squares.begin() + 1);
+
+	Vector<int> copy(squares);
+	copy.reserve(64);
+
+	int sum = 0;
+	for (int value : copy)
+	{
+		sum += value;
+	}
+
+	return sum;
+}
+
+constexpr Vector<int> MakeFibonacci()
+{
+	Vector<int> fibonacci = { 1, 1 };
+
+	while (fibonacci.size() < 12)
+	{
+		fibonacci.push_back(fibonacci[fibonacci.size() - 1] + fibonacci[fibonacci.size() - 2]);
+	}
+
+	return fibonacci;
+}
+
+TEST(ConstexprTests, GivenConstantEvaluation_VectorOperationsWork)
+{
+	static_assert(SumOfSquares(10) == 100 + 285);
+	static_assert(MakeFibonacci().size() == 12);
+	static_assert(MakeFibonacci().back() == 144);
+}
+
+TEST(ConstexprTests, GivenConstexprGenerator_FreezeVectorProducesAStaticArray)
+{
+	static constexpr auto kFibonacci = freeze_vector<MakeFibonacci>();
+
+	static_assert(kFibonacci.size() == 12);
+	static_assert(kFibonacci[11] == 144);
+	EXPECT_EQ(kFibonacci[5], 8);
+}
+#endif
+
+static int sFreeDeleterCount = 0;
+
+static void FreeDeleter(int* container, std::size_t)
+{
+	sFreeDeleterCount += 1;
+	std::free(container);
+}
+
+typedef Vector<int, std::size_t, VectorCustomDeleter> AdoptingVector;
+
+TEST(AdoptReleaseTests, GivenForeignBuffer_AdoptUsesItWithoutCopying)
+{
+	sFreeDeleterCount = 0;
+	int* buffer = static_cast<int*>(std::malloc(sizeof(int) * 4));
+	for (int i = 0; i < 3; ++i)
+	{
+		buffer[i] = i;
+	}
+
+	{
+		AdoptingVector v;
+		v.adopt(buffer, 3, 4, &FreeDeleter);
+
+		EXPECT_EQ(v.data(), buffer);
+		EXPECT_EQ(v.capacity(), 4);
+		v.push_back(3);
+		EXPECT_EQ(v.data(), buffer);
+		EXPECT_TRUE(VerifySequence(v.begin(), v.end(), int(), "vector.adopt", 0, 1, 2, 3, -1));
+		EXPECT_EQ(sFreeDeleterCount, 0);
+	}
+
+	EXPECT_EQ(sFreeDeleterCount, 1);
+}
+
+TEST(AdoptReleaseTests, GivenAdoptedBuffer_GrowthFreesItWithItsDeleter)
+{
+	sFreeDeleterCount = 0;
+	int* buffer = static_cast<int*>(std::malloc(sizeof(int) * 2));
+	buffer[0] = 1;
+	buffer[1] = 2;
+
+	AdoptingVector v;
+	v.adopt(buffer, 2, 2, &FreeDeleter);
+	v.push_back(3);
+
+	EXPECT_EQ(sFreeDeleterCount, 1);
+	EXPECT_NE(v.data(), buffer);
+	EXPECT_TRUE(VerifySequence(v.begin(), v.end(), int(), "vector.adopt", 1, 2, 3, -1));
+}
+
+TEST(AdoptReleaseTests, GivenVector_ReleaseHandsOverTheBufferAndLeavesItEmpty)
+{
+	Vector<int> source = { 1, 2, 3 };
+	const int* buffer = source.data();
+
+	Vector<int>::buffer_type released = source.release();
+
+	EXPECT_TRUE(source.empty());
+	EXPECT_EQ(source.capacity(), 0);
+	EXPECT_EQ(source.data(), nullptr);
+	EXPECT_EQ(released.data, buffer);
+	EXPECT_EQ(released.size, 3);
+
+	Vector<int> destination;
+	destination.adopt(released.data, released.size, released.capacity);
+
+	EXPECT_EQ(destination.data(), buffer);
+	EXPECT_TRUE(VerifySequence(destination.begin(), destination.end(), int(), "vector.release", 1, 2, 3, -1));
+}
+
+TEST(AdoptReleaseTests, GivenAdoptedBuffer_ReleaseReturnsTheOriginalDeleter)
+{
+	sFreeDeleterCount = 0;
+	int* buffer = static_cast<int*>(std::malloc(sizeof(int)));
+
+	AdoptingVector v;
+	v.adopt(buffer, 0, 1, &FreeDeleter);
+
+	AdoptingVector::buffer_type released = v.release();
+	EXPECT_EQ(released.deleter, &FreeDeleter);
+
+	released.deleter(released.data, released.capacity);
+	EXPECT_EQ(sFreeDeleterCount, 1);
+}
+
+TEST(AdoptReleaseTests, GivenAdoptedBuffer_DeleterMovesWithTheBuffer)
+{
+	sFreeDeleterCount = 0;
+	int* buffer = static_cast<int*>(std::malloc(sizeof(int) * 2));
+	buffer[0] = 1;
+
+	AdoptingVector target;
+	{
+		AdoptingVector v;
+		v.adopt(buffer, 1, 2, &FreeDeleter);
+
+		AdoptingVector moved(std::move(v));
+		target = std::move(moved);
+		EXPECT_EQ(sFreeDeleterCount, 0);
+	}
+
+	EXPECT_EQ(target.data(), buffer);
+	EXPECT_EQ(sFreeDeleterCount, 0);
+
+	target.shrink_to_fit();
+	EXPECT_EQ(sFreeDeleterCount, 1);
+
+	target.push_back(2);
+	target = AdoptingVector();
+	EXPECT_EQ(sFreeDeleterCount, 1);
+}
+
+TEST(AdoptReleaseTests, GivenNullBuffer_AdoptKeepsNoDeleter)
+{
+	sFreeDeleterCount = 0;
+	{
+		AdoptingVector v;
+		v.adopt(nullptr, 0, 0, &FreeDeleter);
+		EXPECT_EQ(v.release().deleter, &AdoptingVector::deallocate_buffer);
+	}
+	EXPECT_EQ(sFreeDeleterCount, 0);
+}
+
+TEST(AdoptReleaseTests, GivenDefaultDeleter_VectorSizeIsUnchanged)
+{
+	EXPECT_EQ(sizeof(Vector<int>), sizeof(int*) + 2 * sizeof(std::size_t));
+	EXPECT_EQ(sizeof(AdoptingVector), sizeof(Vector<int>) + sizeof(AdoptingVector::buffer_deleter));
+}
+
+TEST(AdoptReleaseTests, GivenTestObjectBuffer_ReleasedElementsCanBeDestroyedByTheReceiver)
+{
+	TestObject::Reset();
+	{
+		Vector<TestObject> v(5);
+		Vector<TestObject>::buffer_type released = v.release();
+
+		std::destroy(released.data, released.data + released.size);
+		released.deleter(released.data, released.capacity);
+	}
+	EXPECT_TRUE(TestObject::IsClear());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// AllocationCounter
+///
+/// Installs VectorAllocationHooks for its lifetime and counts the calls.
+///
+struct AllocationCounter
+{
+	AllocationCounter()
+	{
+		sAllocations = 0;
+		sDeallocations = 0;
+		VectorAllocationHooks::onAllocate = [](void*, std::size_t) { sAllocations += 1; };
+		VectorAllocationHooks::onDeallocate = [](void*, std::size_t) { sDeallocations += 1; };
+	}
+
+	~AllocationCounter()
+	{
+		VectorAllocationHooks::onAllocate = nullptr;
+		VectorAllocationHooks::onDeallocate = nullptr;
+	}
+
+	static inline int64_t sAllocations = 0;
+	static inline int64_t sDeallocations = 0;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+/// ExpectWithinBudget
+///
+/// Checks the TestObject copies and moves and the allocations made since the
+/// last reset against the maximum an operation is allowed to cost. Copies and
+/// moves include both constructions and assignments.
+///
+static void ExpectWithinBudget(const char* operation, int64_t maxCopies, int64_t maxMoves, int64_t maxAllocations)
+{
+	const int64_t copies = TestObject::sTOCopyCtorCount + TestObject::sTOCopyAssignCount;
+	const int64_t moves = TestObject::sTOMoveCtorCount + TestObject::sTOMoveAssignCount;
+
+	EXPECT_LE(copies, maxCopies) << operation;
+	EXPECT_LE(moves, maxMoves) << operation;
+	EXPECT_LE(AllocationCounter::sAllocations, maxAllocations) << operation;
+}
+
+static Vector<TestObject> MakeTestObjectVector(int count, int capacity)
+{
+	Vector<TestObject> v;
+	v.reserve(capacity);
+
+	for (int i = 0; i < count; ++i)
+	{
+		v.emplace_back(i);
+	}
+
+	return v;
+}
+
+TEST(CopyMoveBudgetTests, GivenEmptyVector_PushBackWithGrowthCopiesOnlyOnReallocation)
+{
+	const int count = 100;
+	Vector<TestObject> v;
+	TestObject::Reset();
+	AllocationCounter counter;
+
+	for (int i = 0; i < count; ++i)
+	{
+		v.push_back(TestObject(i));
+	}
+
+	// TestObject's move may throw, so each reallocation copies the old elements:
+	// 2 + 4 + ... + 64 of them on the way to a capacity of 128.
+	ExpectWithinBudget("push_back with growth", 126, count, 7);
+}
+
+TEST(CopyMoveBudgetTests, GivenReservedVector_PushBackCopiesOncePerElement)
+{
+	const int count = 100;
+	Vector<TestObject> v;
+	v.reserve(count);
+	const TestObject element(1);
+	TestObject::Reset();
+	AllocationCounter counter;
+
+	for (int i = 0; i < count; ++i)
+	{
+		v.push_back(element);
+	}
+
+	ExpectWithinBudget("push_back into reserved storage", count, 0, 0);
+}
+
+TEST(CopyMoveBudgetTests, GivenReservedVector_InsertCostIsBoundedByTheShiftedElements)
+{
+	const int count = 50;
+
+	// The new element is moved into a temporary before the shift, in case the
+	// argument aliases an element, and from there into its slot.
+	Vector<TestObject> front = MakeTestObjectVector(count, count + 1);
+	TestObject::Reset();
+	AllocationCounter frontCounter;
+	front.insert(front.begin(), TestObject(-1));
+	ExpectWithinBudget("insert at the front", count, 2, 0);
+
+	Vector<TestObject> middle = MakeTestObjectVector(count, count + 1);
+	TestObject::Reset();
+	AllocationCounter middleCounter;
+	middle.insert(middle.begin() + count / 2, TestObject(-1));
+	ExpectWithinBudget("insert in the middle", count / 2, 2, 0);
+
+	Vector<TestObject> back = MakeTestObjectVector(count, count + 1);
+	TestObject::Reset();
+	AllocationCounter backCounter;
+	back.insert(back.end(), TestObject(-1));
+	ExpectWithinBudget("insert at the end", 0, 1, 0);
+}
+
+TEST(CopyMoveBudgetTests, GivenFullVector_InsertRelocatesEveryElementOnce)
+{
+	const int count = 50;
+	Vector<TestObject> v = MakeTestObjectVector(count, count);
+	TestObject::Reset();
+	AllocationCounter counter;
+
+	v.insert(v.begin() + count / 2, TestObject(-1));
+
+	ExpectWithinBudget("insert with reallocation", count, 1, 1);
+}
+
+TEST(CopyMoveBudgetTests, GivenVector_EraseMovesOnlyTheTail)
+{
+	const int count = 50;
+	Vector<TestObject> v = MakeTestObjectVector(count, count);
+	TestObject::Reset();
+	AllocationCounter counter;
+
+	v.erase(v.begin() + 10);
+	v.erase(v.begin(), v.begin() + 9);
+
+	ExpectWithinBudget("erase", 0, (count - 11) + (count - 10), 0);
+}
+
+TEST(CopyMoveBudgetTests, GivenVector_ReserveRelocatesEveryElementOnce)
+{
+	const int count = 50;
+	Vector<TestObject> v = MakeTestObjectVector(count, count);
+	TestObject::Reset();
+	AllocationCounter counter;
+
+	v.reserve(count * 2);
+	v.reserve(count);
+
+	ExpectWithinBudget("reserve", count, 0, 1);
+	EXPECT_EQ(AllocationCounter::sDeallocations, 1);
+}
+
+TEST(CopyMoveBudgetTests, GivenVectors_CopyAndMoveAssignmentStayWithinBudget)
+{
+	const int count = 50;
+	const Vector<TestObject> source = MakeTestObjectVector(count, count);
+	Vector<TestObject> destination;
+	TestObject::Reset();
+	AllocationCounter copyCounter;
+
+	destination = source;
+	ExpectWithinBudget("copy assignment", count, 0, 1);
+
+	Vector<TestObject> moved = MakeTestObjectVector(count, count);
+	TestObject::Reset();
+	AllocationCounter moveCounter;
+
+	destination = std::move(moved);
+	Vector<TestObject> constructed(std::move(destination));
+	ExpectWithinBudget("move assignment and construction", 0, 0, 0);
+}
+
+TEST(CompactVectorTests, GivenUint32SizeType_VectorIsTwoWords)
+{
+	typedef Vector<int, std::uint32_t> CompactVector;
+
+	EXPECT_EQ(sizeof(CompactVector), sizeof(int*) + 2 * sizeof(std::uint32_t));
+	EXPECT_EQ(CompactVector::max_size(), std::numeric_limits<std::uint32_t>::max());
+}
+
+TEST(CompactVectorTests, GivenUint32SizeType_OperationsMatchTheDefaultVector)
+{
+	TestObject::Reset();
+	{
+		Vector<TestObject, std::uint32_t> v = { TestObject(1), TestObject(3) };
+
+		v.insert(v.begin() + 1, TestObject(2));
+		v.emplace_back(4);
+		v.erase(v.begin());
+
+		Vector<TestObject, std::uint32_t> copy(v);
+		EXPECT_TRUE(copy == v);
+		EXPECT_TRUE(VerifySequence(copy.begin(), copy.end(), int(), "compact vector", 2, 3, 4, -1));
+	}
+	EXPECT_TRUE(TestObject::IsClear());
+}
+
+TEST(CompactVectorTests, GivenNarrowSizeType_GrowthClampsAndThenThrows)
+{
+	Vector<char, std::uint8_t> v;
+
+	for (int i = 0; i < 255; ++i)
+	{
+		v.push_back(static_cast<char>(i));
+	}
+
+	EXPECT_EQ(v.capacity(), 255);
+	EXPECT_EQ(v.size(), 255);
+	EXPECT_THROW(v.push_back('x'), std::length_error);
+	EXPECT_THROW(v.insert(v.begin(), 'x'), std::length_error);
+	EXPECT_EQ(v.size(), 255);
+}
+
+TEST(CompactVectorTests, GivenNarrowSizeType_WideArgumentsAreCheckedBeforeNarrowing)
+{
+	Vector<int, std::uint8_t> v(200);
+
+	EXPECT_THROW(v.at(std::size_t(257)), std::out_of_range);
+	EXPECT_THROW(std::as_const(v).at(std::size_t(256)), std::out_of_range);
+	EXPECT_THROW(v.reserve(300), std::length_error);
+	EXPECT_THROW(v.assign(std::size_t(300), 1), std::length_error);
+	EXPECT_THROW(v.generate_back(std::size_t(100), [] { return 1; }), std::length_error);
+	EXPECT_THROW((Vector<int, std::uint8_t>(std::size_t(300))), std::length_error);
+	EXPECT_EQ(v.size(), 200);
+	EXPECT_EQ(v.capacity(), 200);
+
+	v.shrink_to(std::size_t(256));
+	EXPECT_EQ(v.capacity(), 200);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// ScopedBufferPool
+///
+/// Enables VectorBufferPool on the current thread for its lifetime and leaves
+/// it empty, disabled and with default limits afterwards.
+///
+struct ScopedBufferPool
+{
+	ScopedBufferPool()
+	{
+		VectorBufferPool::trim();
+		VectorBufferPool::reset_stats();
+		VectorBufferPool::enable();
+	}
+
+	~ScopedBufferPool()
+	{
+		VectorBufferPool::enable(false);
+		VectorBufferPool::set_limits(VectorBufferPool::kMaxBuffersPerBucket, std::size_t(16) << 20);
+		VectorBufferPool::trim();
+	}
+};
+
+TEST(BufferPoolTests, GivenDisabledPool_BuffersAreNotCached)
+{
+	VectorBufferPool::reset_stats();
+	{
+		Vector<int> v = { 1, 2, 3 };
+	}
+
+	EXPECT_EQ(VectorBufferPool::stats().recycled, 0);
+	EXPECT_EQ(VectorBufferPool::stats().cachedBuffers, 0);
+}
+
+TEST(BufferPoolTests, GivenEnabledPool_ShortLivedVectorsReuseTheSameBuffer)
+{
+	ScopedBufferPool pool;
+	const int* firstBuffer = nullptr;
+
+	for (int i = 0; i < 10; ++i)
+	{
+		Vector<int> v = { 1, 2, 3, 4 };
+
+		if (i == 0)
+		{
+			firstBuffer = v.data();
+		}
+
+		EXPECT_EQ(v.data(), firstBuffer);
+	}
+
+	const VectorBufferPool::statistics stats = VectorBufferPool::stats();
+	EXPECT_EQ(stats.misses, 1);
+	EXPECT_EQ(stats.hits, 9);
+	EXPECT_EQ(stats.recycled, 10);
+	EXPECT_EQ(stats.cachedBuffers, 1);
+}
+
+TEST(BufferPoolTests, GivenEnabledPool_GrowingVectorTakesBuffersFromItsBucket)
+{
+	ScopedBufferPool pool;
+	{
+		Vector<int> v;
+		for (int i = 0; i < 64; ++i)
+		{
+			v.push_back(i);
+		}
+	}
+
+	VectorBufferPool::reset_stats();
+	AllocationCounter counter;
+	{
+		Vector<int> v;
+		for (int i = 0; i < 64; ++i)
+		{
+			v.push_back(i);
+		}
+	}
+
+	EXPECT_EQ(VectorBufferPool::stats().misses, 0);
+	EXPECT_EQ(AllocationCounter::sAllocations, 0);
+	EXPECT_EQ(AllocationCounter::sDeallocations, 0);
+}
+
+TEST(BufferPoolTests, GivenSmallerRequest_LargerBufferIsNotReused)
+{
+	ScopedBufferPool pool;
+	static int64_t sOutstandingBytes = 0;
+	sOutstandingBytes = 0;
+	VectorAllocationHooks::onAllocate = [](void*, std::size_t bytes) { sOutstandingBytes += bytes; };
+	VectorAllocationHooks::onDeallocate = [](void*, std::size_t bytes) { sOutstandingBytes -= bytes; };
+	{
+		Vector<char> v;
+		v.reserve(100);
+	}
+	{
+		Vector<char> small;
+		small.reserve(60);
+		EXPECT_EQ(small.capacity(), 60);
+	}
+
+	EXPECT_EQ(VectorBufferPool::stats().misses, 2);
+	EXPECT_EQ(VectorBufferPool::stats().cachedBytes, 160);
+
+	VectorBufferPool::trim();
+	VectorAllocationHooks::onAllocate = nullptr;
+	VectorAllocationHooks::onDeallocate = nullptr;
+
+	EXPECT_EQ(sOutstandingBytes, 0);
+}
+
+TEST(BufferPoolTests, GivenLimits_ExtraBuffersAreFreedAndTrimEmptiesThePool)
+{
+	ScopedBufferPool pool;
+	VectorBufferPool::set_limits(2, 100000);
+	{
+		Vector<int> a(16);
+		Vector<int> b(16);
+		Vector<int> c(16);
+		Vector<int> d(100000);
+	}
+
+	VectorBufferPool::statistics stats = VectorBufferPool::stats();
+	EXPECT_EQ(stats.recycled, 2);
+	EXPECT_EQ(stats.dropped, 2);
+	EXPECT_EQ(stats.cachedBuffers, 2);
+	EXPECT_EQ(stats.cachedBytes, 2 * 16 * sizeof(int));
+
+	VectorBufferPool::trim();
+	stats = VectorBufferPool::stats();
+	EXPECT_EQ(stats.cachedBuffers, 0);
+	EXPECT_EQ(stats.cachedBytes, 0);
+}
+
+TEST(BufferPoolTests, GivenThreadLocalVectorOutlivingThePool_ItIsFreedAtThreadExit)
+{
+	AllocationCounter counter;
+
+	std::thread([]()
+	{
+		static thread_local Vector<int> outlivesPool(100);
+		VectorBufferPool::enable();
+
+		Vector<int> cached(100);
+	}).join();
+
+	// The cached buffer is freed when the pool empties itself, the
+	// thread_local one afterwards, once the pool no longer takes buffers.
+	EXPECT_EQ(AllocationCounter::sAllocations, 2);
+	EXPECT_EQ(AllocationCounter::sDeallocations, 2);
+}
+
+TEST(ClearTests, GivenClearedVector_RefillingItAllocatesNothing)
+{
+	Vector<TestObject> v;
+	for (int i = 0; i < 100; ++i)
+	{
+		v.emplace_back(i);
+	}
+	const TestObject* buffer = v.data();
+
+	AllocationCounter counter;
+
+	for (int cycle = 0; cycle < 10; ++cycle)
+	{
+		v.clear();
+		EXPECT_TRUE(v.empty());
+		EXPECT_EQ(v.capacity(), 128);
+
+		for (int i = 0; i < 100; ++i)
+		{
+			v.emplace_back(i);
+		}
+	}
+
+	EXPECT_EQ(v.data(), buffer);
+	EXPECT_EQ(AllocationCounter::sAllocations, 0);
+	EXPECT_EQ(AllocationCounter::sDeallocations, 0);
+
+	v.clear();
+	EXPECT_EQ(TestObject::sTOCount, 0);
+}
+
+TEST(ClearTests, GivenSpareCapacity_ShrinkToFitGivesItBack)
+{
+	Vector<int> v;
+	v.reserve(100);
+	v.push_back(1);
+	v.push_back(2);
+
+	v.shrink_to(50);
+	EXPECT_EQ(v.capacity(), 50);
+
+	v.shrink_to_fit();
+	EXPECT_EQ(v.capacity(), 2);
+	EXPECT_EQ(v[1], 2);
+
+	AllocationCounter counter;
+	v.clear();
+	v.shrink_to_fit();
+	EXPECT_EQ(v.capacity(), 0);
+	EXPECT_EQ(v.data(), nullptr);
+	EXPECT_EQ(AllocationCounter::sDeallocations, 1);
+
+	v.push_back(3);
+	EXPECT_EQ(v[0], 3);
+}
+
+TEST(ClearTests, GivenMostlyEmptyScratchVector_DecayPolicyTrimsItToTheHighWatermark)
+{
+	Vector<int> scratch;
+	scratch.reserve(1000);
+	VectorDecayPolicy decay(3, 4);
+
+	for (int cycle = 0; cycle < 2; ++cycle)
+	{
+		for (int i = 0; i < 10 + cycle * 20; ++i)
+		{
+			scratch.push_back(i);
+		}
+
+		EXPECT_FALSE(decay.end_cycle(scratch));
+		scratch.clear();
+	}
+
+	// A busy cycle starts the count again.
+	for (int i = 0; i < 600; ++i)
+	{
+		scratch.push_back(i);
+	}
+	EXPECT_FALSE(decay.end_cycle(scratch));
+	scratch.clear();
+
+	for (int cycle = 0; cycle < 3; ++cycle)
+	{
+		for (int i = 0; i < 10 + cycle * 20; ++i)
+		{
+			scratch.push_back(i);
+		}
+
+		EXPECT_EQ(decay.end_cycle(scratch), cycle == 2);
+		scratch.clear();
+	}
+
+	EXPECT_EQ(scratch.capacity(), 50);
+}
+
+TEST(BulkTests, GivenIteratorRanges_ConstructorCopiesThemWithOneAllocation)
+{
+	const std::list<int> list = { 1, 3, 5 };
+	AllocationCounter counter;
+
+	const Vector<int> fromList(list.begin(), list.end());
+	EXPECT_TRUE(VerifySequence(fromList.begin(), fromList.end(), int(), "Vector(list)", 1, 3, 5, -1));
+	EXPECT_EQ(fromList.capacity(), 3);
+	EXPECT_EQ(AllocationCounter::sAllocations, 1);
+
+	std::istringstream stream("7 8 9");
+	const Vector<int> fromStream{ std::istream_iterator<int>(stream), std::istream_iterator<int>() };
+	EXPECT_TRUE(VerifySequence(fromStream.begin(), fromStream.end(), int(), "Vector(istream)", 7, 8, 9, -1));
+}
+
+TEST(BulkTests, GivenAssign_ExistingCapacityIsReused)
+{
+	Vector<int> v;
+	v.reserve(10);
+	v.push_back(9);
+	const int* buffer = v.data();
+
+	const int values[] = { 1, 2, 3, 4 };
+	v.assign(std::begin(values), std::end(values));
+	EXPECT_TRUE(VerifySequence(v.begin(), v.end(), int(), "assign(first, last)", 1, 2, 3, 4, -1));
+	EXPECT_EQ(v.data(), buffer);
+
+	v.assign(3, v[3]);
+	EXPECT_TRUE(VerifySequence(v.begin(), v.end(), int(), "assign(n, value)", 4, 4, 4, -1));
+
+	v.assign(20, 5);
+	EXPECT_EQ(v.size(), 20);
+	EXPECT_EQ(v.capacity(), 20);
+	EXPECT_EQ(v[19], 5);
+}
+
+TEST(BulkTests, GivenOwnElements_AppendCopiesThemBeforeReallocating)
+{
+	Vector<TestObject> v;
+	v.emplace_back(1);
+	v.emplace_back(2);
+	ASSERT_EQ(v.size(), v.capacity());
+
+	v.append(v);
+
+	ASSERT_EQ(v.size(), 4);
+	EXPECT_EQ(v[2].mX, 1);
+	EXPECT_EQ(v[3].mX, 2);
+
+	v.append(std::list<TestObject>{ TestObject(5) });
+	EXPECT_EQ(v.back().mX, 5);
+}
+
+TEST(BulkTests, GivenThrowingCopy_AppendLeavesTheVectorUnchanged)
+{
+	Vector<TestObject> v;
+	v.emplace_back(1);
+
+	const TestObject values[] = { TestObject(2), TestObject(3, true) };
+	EXPECT_ANY_THROW(v.append(std::begin(values), std::end(values)));
+
+	ASSERT_EQ(v.size(), 1);
+	EXPECT_EQ(v[0].mX, 1);
+
+	int next = 0;
+	EXPECT_ANY_THROW(v.generate_back(3, [&next]()
+	{
+		next += 1;
+		return TestObject(next, next == 2);
+	}));
+	EXPECT_EQ(v.size(), 1);
+}
+
+TEST(BulkTests, GivenRvalueVector_AppendStealsTheBufferOfAnEmptyVector)
+{
+	Vector<int> source = { 1, 2, 3 };
+	const int* buffer = source.data();
+
+	Vector<int> v;
+	v.append(std::move(source));
+	EXPECT_EQ(v.data(), buffer);
+	EXPECT_TRUE(source.empty());
+
+	v.append(Vector<int>{ 4, 5 });
+	EXPECT_TRUE(VerifySequence(v.begin(), v.end(), int(), "append(Vector&&)", 1, 2, 3, 4, 5, -1));
+}
+
+TEST(BulkTests, GivenItself_AppendRvalueCopiesTheElementsInsteadOfClearing)
+{
+	Vector<int> v = { 1, 2, 3 };
+	v.append(std::move(v));
+	EXPECT_TRUE(VerifySequence(v.begin(), v.end(), int(), "append(self)", 1, 2, 3, 1, 2, 3, -1));
+
+	Vector<std::string> strings = { "a", "b" };
+	strings.append(std::move(strings));
+	EXPECT_TRUE(strings == (Vector<std::string>{ "a", "b", "a", "b" }));
+}
+
+TEST(BulkTests, GivenGenerator_GenerateBackAppendsItsResults)
+{
+	Vector<int> v = { 0 };
+	int next = 1;
+
+	AllocationCounter counter;
+	v.generate_back(1000, [&next]() { return next++; });
+
+	ASSERT_EQ(v.size(), 1001);
+	EXPECT_EQ(v[1000], 1000);
+	EXPECT_EQ(AllocationCounter::sAllocations, 1);
+}
+
+TEST(ErrorPolicyTests, GivenThrowPolicy_RaiseThrowsTheMatchingException)
+{
+	static_assert(VECTOR_ERROR_POLICY == VECTOR_ERROR_THROW, "the tests build with exceptions");
+
+	EXPECT_THROW(VectorErrorPolicy::raise(VectorError::OutOfRange, "out of range"), std::out_of_range);
+	EXPECT_THROW(VectorErrorPolicy::raise(VectorError::Range, "range"), std::range_error);
+	EXPECT_THROW(VectorErrorPolicy::raise(VectorError::Length, "length"), std::length_error);
+	EXPECT_THROW(VectorErrorPolicy::raise(VectorError::BadAlloc, "bad alloc"), std::bad_alloc);
+
+	Vector<int> v;
+	EXPECT_THROW(v.at(0), std::out_of_range);
+	EXPECT_THROW(v.front(), std::range_error);
+}
+
+TEST(AccessPolicyTests, GivenDefaultPolicy_OnlyFrontBackAndAtAreChecked)
+{
+	Vector<int> v;
+
+	static_assert(noexcept(v[0]), "operator[] is unchecked by default");
+	EXPECT_THROW(v.front(), std::range_error);
+	EXPECT_THROW(std::as_const(v).back(), std::range_error);
+	EXPECT_THROW(v.at(0), std::out_of_range);
+
+	EXPECT_EQ(v.emplace_back(7), 7);
+	EXPECT_EQ(&v.front(), &v.back());
+}
+
+TEST(PushBackTests, GivenFullVector_PushBackOfOwnElementCopiesItBeforeGrowing)
+{
+	Vector<TestObject> v;
+	v.emplace_back(1);
+	v.emplace_back(2);
+	ASSERT_EQ(v.size(), v.capacity());
+
+	v.push_back(v[0]);
+	v.emplace_back(v[1]);
+
+	ASSERT_EQ(v.size(), 4);
+	EXPECT_EQ(v[2].mX, 1);
+	EXPECT_EQ(v[3].mX, 2);
+}
+
+TEST(ReclaimerTests, GivenEnabledReclaimer_LargeBuffersAreFreedInTheBackground)
+{
+	VectorReclaimer::enable(1 << 20);
+	VectorReclaimer::reset_stats();
+	AllocationCounter counter;
+
+	{
+		Vector<int> large(1 << 20);
+		Vector<int> small(1000);
+		Vector<std::string> strings(1 << 18);
+	}
+
+	// Only the buffers over the threshold are deferred, but every buffer is
+	// reported as released when the Vector lets go of it.
+	EXPECT_EQ(AllocationCounter::sDeallocations, 3);
+	EXPECT_EQ(VectorReclaimer::stats().deferred, 2);
+
+	Vector<std::uint8_t> target(std::size_t(4) << 20);
+	target = Vector<std::uint8_t>(std::size_t(2) << 20);
+	EXPECT_EQ(VectorReclaimer::stats().deferred, 3);
+
+	VectorReclaimer::flush();
+	VectorReclaimer::statistics stats = VectorReclaimer::stats();
+	EXPECT_EQ(stats.queuedBuffers, 0);
+	EXPECT_EQ(stats.queuedBytes, 0);
+
+	VectorReclaimer::disable();
+	EXPECT_FALSE(VectorReclaimer::enabled());
+
+	{
+		Vector<int> large(1 << 20);
+	}
+	EXPECT_EQ(VectorReclaimer::stats().deferred, 3);
+}
+
+TEST(ReclaimerTests, GivenFullQueue_BuffersAreFreedInline)
+{
+	VectorReclaimer::enable(1 << 16, 1);
+	VectorReclaimer::reset_stats();
+
+	for (int i = 0; i < 50; ++i)
+	{
+		Vector<double> v(1 << 14);
+	}
+
+	const VectorReclaimer::statistics stats = VectorReclaimer::stats();
+	EXPECT_EQ(stats.deferred + stats.freedInline, 50);
+	EXPECT_LE(stats.queuedBuffers, 1);
+
+	VectorReclaimer::disable();
+	EXPECT_EQ(VectorReclaimer::stats().queuedBuffers, 0);
+}
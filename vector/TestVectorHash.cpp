@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include "VectorHash.h"
+
+TEST(VectorHashTests, GivenEqualVectors_HashesAreEqualAndSingleByteChangesAlterTheHash)
+{
+	std::hash<Vector<std::uint8_t>> hasher;
+
+	// Every length exercises a different tail of the block hash: the short
+	// paths, the 16-byte loop and the three-lane 48-byte loop.
+	for (std::size_t length = 0; length < 200; ++length)
+	{
+		Vector<std::uint8_t> a;
+		for (std::size_t i = 0; i < length; ++i)
+		{
+			a.push_back(static_cast<std::uint8_t>(i * 31 + 7));
+		}
+
+		Vector<std::uint8_t> b(a);
+		EXPECT_EQ(hasher(a), hasher(b));
+
+		std::unordered_set<std::size_t> seen = { hasher(a) };
+
+		for (std::size_t i = 0; i < length; ++i)
+		{
+			b[i] ^= 1;
+			EXPECT_TRUE(seen.insert(hasher(b)).second) << "length " << length << ", byte " << i;
+			b[i] ^= 1;
+		}
+
+		b.push_back(0);
+		EXPECT_NE(hasher(a), hasher(b));
+	}
+}
+
+TEST(VectorHashTests, GivenElementsWithoutUniqueRepresentation_ElementHashesAreCombined)
+{
+	std::hash<Vector<double>> doubleHasher;
+	std::hash<Vector<std::string>> stringHasher;
+
+	// -0.0 and 0.0 compare equal but differ in their bytes.
+	EXPECT_EQ(doubleHasher({ 1.5, 0.0 }), doubleHasher({ 1.5, -0.0 }));
+	EXPECT_NE(doubleHasher({ 1.5, 2.5 }), doubleHasher({ 2.5, 1.5 }));
+
+	// Equal strings in different buffers hash the same; order matters.
+	EXPECT_EQ(stringHasher({ std::string(40, 'a'), "b" }), stringHasher({ std::string(40, 'a'), "b" }));
+	EXPECT_NE(stringHasher({ "a", "b" }), stringHasher({ "b", "a" }));
+	EXPECT_NE(stringHasher({}), stringHasher({ "" }));
+}
+
+TEST(VectorHashTests, GivenIntegerVectorKeys_UnorderedMapFindsThem)
+{
+	std::unordered_map<Vector<int>, int> counts;
+
+	for (int i = 0; i < 1000; ++i)
+	{
+		counts[{ i % 10, i % 7 }] += 1;
+	}
+
+	EXPECT_EQ(counts.size(), 70);
+	EXPECT_EQ(counts.at({ 3, 3 }), 15);
+	EXPECT_EQ(counts.count({ 3, 8 }), 0);
+}
+
+TEST(VectorHashTests, GivenHashedVector_HashIsComputedOnceAndMatchesVectorHash)
+{
+	Vector<std::uint32_t> key;
+	for (std::uint32_t i = 0; i < 100000; ++i)
+	{
+		key.push_back(i * 2654435761u);
+	}
+
+	const std::size_t expected = std::hash<Vector<std::uint32_t>>()(key);
+	const std::uint32_t* buffer = key.data();
+
+	HashedVector<std::uint32_t> hashed(std::move(key));
+	EXPECT_EQ(hashed.data(), buffer);
+	EXPECT_EQ(std::hash<HashedVector<std::uint32_t>>()(hashed), expected);
+	EXPECT_EQ(hashed.size(), 100000);
+	EXPECT_EQ(hashed[1], 2654435761u);
+
+	std::unordered_set<HashedVector<std::uint32_t>> keys;
+	keys.insert(hashed);
+	keys.insert(HashedVector<std::uint32_t>(Vector<std::uint32_t>{ 1, 2, 3 }));
+
+	EXPECT_EQ(keys.size(), 2);
+	EXPECT_EQ(keys.count(hashed), 1);
+	EXPECT_EQ(keys.count(HashedVector<std::uint32_t>(Vector<std::uint32_t>{ 1, 2 })), 0);
+	EXPECT_TRUE(HashedVector<std::uint32_t>(Vector<std::uint32_t>{ 1, 2, 3 }) == HashedVector<std::uint32_t>(Vector<std::uint32_t>{ 1, 2, 3 }));
+}
@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include "VectorNuma.h"
+#include "TestObject.h"
+
+TEST(VectorNumaTests, GivenAnyMachine_AtLeastOneNodeIsReported)
+{
+	EXPECT_GE(VectorNuma::node_count(), 1);
+	EXPECT_GT(VectorNuma::page_size(), 0);
+}
+
+TEST(VectorNumaTests, GivenEveryPlacement_MakeVectorValueInitializesTheElements)
+{
+	const NumaPlacement placements[] = { NumaPlacement::Local, NumaPlacement::FirstTouchPerNode, NumaPlacement::Interleave };
+
+	for (NumaPlacement placement : placements)
+	{
+		Vector<int> v = numa_make_vector<int>(std::size_t(100000), placement);
+
+		ASSERT_EQ(v.size(), 100000);
+		EXPECT_TRUE(std::all_of(v.begin(), v.end(), [](int value) { return value == 0; }));
+	}
+}
+
+TEST(VectorNumaTests, GivenEveryPlacement_BufferStartsOnAPage)
+{
+	const NumaPlacement placements[] = { NumaPlacement::Local, NumaPlacement::FirstTouchPerNode, NumaPlacement::Interleave };
+
+	for (NumaPlacement placement : placements)
+	{
+		Vector<char> v = numa_make_vector<char>(std::size_t(100), placement);
+		EXPECT_EQ(reinterpret_cast<std::uintptr_t>(v.data()) % VectorNuma::page_size(), 0);
+
+		numa_reserve(v, std::size_t(5000), placement);
+		EXPECT_EQ(reinterpret_cast<std::uintptr_t>(v.data()) % VectorNuma::page_size(), 0);
+	}
+}
+
+TEST(VectorNumaTests, GivenElementsStraddlingPages_NodeSlicesStartAtPageBoundaries)
+{
+	struct Triple
+	{
+		double values[3];
+	};
+
+	const std::size_t page = VectorNuma::page_size();
+	const std::size_t size = sizeof(Triple);
+	const std::size_t count = 10000;
+	std::size_t expectedFirst = 0;
+
+	for (std::size_t nodeIndex = 0; nodeIndex < 3; ++nodeIndex)
+	{
+		const auto slice = VectorNuma::node_slice(nodeIndex, 3, count, size);
+
+		EXPECT_EQ(slice.first, expectedFirst);
+		if (slice.first > 0)
+		{
+			// A page boundary lies between the previous element and the first one.
+			EXPECT_GT(slice.first * size / page, (slice.first - 1) * size / page);
+		}
+
+		expectedFirst = slice.second;
+	}
+
+	EXPECT_EQ(expectedFirst, count);
+}
+
+TEST(VectorNumaTests, GivenGenerator_ElementIComesFromGeneratorI)
+{
+	TestObject::Reset();
+	{
+		Vector<TestObject> v = numa_generate_vector<TestObject>(std::size_t(5000), NumaPlacement::FirstTouchPerNode,
+			[](std::size_t i) { return TestObject(static_cast<int>(i)); });
+
+		ASSERT_EQ(v.size(), 5000);
+		for (int i = 0; i < 5000; ++i)
+		{
+			EXPECT_EQ(v[i].mX, i);
+		}
+	}
+	EXPECT_TRUE(TestObject::IsClear());
+}
+
+TEST(VectorNumaTests, GivenThrowingGenerator_ConstructedElementsAreDestroyed)
+{
+	TestObject::Reset();
+
+	EXPECT_THROW(numa_generate_vector<TestObject>(std::size_t(5000), NumaPlacement::Interleave, [](std::size_t i)
+	{
+		if (i == 4000)
+		{
+			throw std::runtime_error("generator failed");
+		}
+
+		return TestObject(static_cast<int>(i));
+	}), std::runtime_error);
+
+	EXPECT_TRUE(TestObject::IsClear());
+}
+
+TEST(VectorNumaTests, GivenVector_NumaReserveKeepsTheElements)
+{
+	Vector<int> v = { 1, 2, 3 };
+
+	numa_reserve(v, std::size_t(50000), NumaPlacement::FirstTouchPerNode);
+
+	EXPECT_EQ(v.capacity(), 50000);
+	EXPECT_TRUE(v == Vector<int>({ 1, 2, 3 }));
+
+	v.push_back(4);
+	EXPECT_EQ(v.back(), 4);
+}
+
+TEST(VectorNumaTests, GivenTouchedVector_PageNodesCoverEveryPage)
+{
+	Vector<int> v = numa_make_vector<int>(std::size_t(100000), NumaPlacement::FirstTouchPerNode);
+	const Vector<int> pages = numa_page_nodes(v);
+
+	const std::size_t bytes = sizeof(int) * v.capacity();
+	EXPECT_GE(pages.size(), bytes / VectorNuma::page_size());
+	EXPECT_LE(pages.size(), bytes / VectorNuma::page_size() + 2);
+
+	// Sandboxes may refuse move_pages; when they don't, every page sits on an online node.
+	for (int node : pages)
+	{
+		if (node >= 0)
+		{
+			EXPECT_NE(std::find(VectorNuma::nodes().begin(), VectorNuma::nodes().end(), node), VectorNuma::nodes().end());
+		}
+	}
+}
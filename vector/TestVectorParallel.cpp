@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include "VectorParallel.h"
+
+// The pool starts on first use; give it workers even on a single core so that
+// splitting and stealing are exercised.
+static const bool sPoolConfigured = (VectorThreadPool::sMaximumThreads = 4, true);
+
+static Vector<std::uint32_t> MakeSequence(std::size_t count)
+{
+	Vector<std::uint32_t> v;
+	v.reserve(count);
+
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		v.push_back(static_cast<std::uint32_t>(i * 2654435761u >> 7));
+	}
+
+	return v;
+}
+
+TEST(VectorParallelTests, GivenUnevenWork_ParallelForVisitsEveryIndexOnce)
+{
+	const std::size_t count = 100000;
+	Vector<std::atomic<int>> visits(count);
+	std::atomic<std::uint64_t> work(0);
+
+	EXPECT_EQ(VectorThreadPool::instance().thread_count(), 4);
+
+	// Later indices cost far more, so an even static split would leave most
+	// threads idle; every index must still be covered exactly once.
+	VectorThreadPool::instance().parallel_for(count, 16, [&](std::size_t begin, std::size_t end)
+	{
+		EXPECT_LE(end - begin, 16);
+
+		for (std::size_t i = begin; i < end; ++i)
+		{
+			std::uint64_t spin = 0;
+			for (std::size_t j = 0; j < i / 1000; ++j)
+			{
+				spin += j;
+			}
+
+			work.fetch_add(spin, std::memory_order_relaxed);
+			visits[i].fetch_add(1, std::memory_order_relaxed);
+		}
+	});
+
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		ASSERT_EQ(visits[i].load(), 1) << i;
+	}
+}
+
+TEST(VectorParallelTests, GivenVector_ForEachAndTransformMatchTheSerialResult)
+{
+	Vector<std::uint32_t> v = MakeSequence(300001);
+	Vector<std::uint32_t> expected(v);
+
+	parallel_for_each(v, [](std::uint32_t& value) { value = value * 3 + 1; });
+	std::for_each(expected.begin(), expected.end(), [](std::uint32_t& value) { value = value * 3 + 1; });
+	EXPECT_TRUE(v == expected);
+
+	const Vector<double> halves = parallel_transform(v, [](std::uint32_t value) { return value / 2.0; });
+	ASSERT_EQ(halves.size(), v.size());
+	EXPECT_EQ(halves[12345], v[12345] / 2.0);
+	EXPECT_EQ(halves[300000], v[300000] / 2.0);
+
+	const Vector<std::string> names = parallel_transform(Vector<int>{ 1, 2, 3 }, [](int value) { return std::to_string(value); });
+	EXPECT_TRUE(names == (Vector<std::string>{ "1", "2", "3" }));
+}
+
+TEST(VectorParallelTests, GivenNonCommutativeOperation_ReduceCombinesBlocksInOrder)
+{
+	const Vector<std::uint32_t> v = MakeSequence(1000003);
+
+	EXPECT_EQ(parallel_reduce(v, 7), std::accumulate(v.begin(), v.end(), std::uint32_t(7)));
+	EXPECT_EQ(parallel_reduce(v, 0, [](std::uint32_t a, std::uint32_t b) { return std::max(a, b); }), *std::max_element(v.begin(), v.end()));
+	EXPECT_EQ(parallel_reduce(Vector<int>(), 5), 5);
+
+	// Composing affine maps x -> a * x + b is associative but not commutative.
+	struct affine
+	{
+		std::uint64_t a;
+		std::uint64_t b;
+	};
+
+	Vector<affine> maps;
+	for (std::uint32_t value : v)
+	{
+		maps.push_back(affine{ value | 1u, value });
+	}
+
+	auto compose = [](const affine& f, const affine& g) { return affine{ g.a * f.a, g.a * f.b + g.b }; };
+	const affine parallel = parallel_reduce(maps, affine{ 1, 0 }, compose);
+	const affine serial = std::accumulate(maps.begin(), maps.end(), affine{ 1, 0 }, compose);
+
+	EXPECT_EQ(parallel.a, serial.a);
+	EXPECT_EQ(parallel.b, serial.b);
+}
+
+TEST(VectorParallelTests, GivenVector_ScansMatchStdPartialSum)
+{
+	for (std::size_t count : { std::size_t(0), std::size_t(1), std::size_t(5000), std::size_t(777777) })
+	{
+		const Vector<std::uint32_t> v = MakeSequence(count);
+
+		Vector<std::uint32_t> expected(v);
+		std::partial_sum(v.begin(), v.end(), expected.begin());
+		EXPECT_TRUE(parallel_inclusive_scan(v) == expected) << count;
+
+		Vector<std::uint32_t> shifted(v);
+		std::uint32_t running = 100;
+		for (std::uint32_t& value : shifted)
+		{
+			running += std::exchange(value, running);
+		}
+		EXPECT_TRUE(parallel_exclusive_scan(v, 100) == shifted) << count;
+	}
+
+	const Vector<std::string> words = { "a", "b", "c" };
+	EXPECT_TRUE(parallel_inclusive_scan(words) == (Vector<std::string>{ "a", "ab", "abc" }));
+	EXPECT_TRUE(parallel_exclusive_scan(words, std::string(">")) == (Vector<std::string>{ ">", ">a", ">ab" }));
+}
+
+TEST(VectorParallelTests, GivenPredicate_CopyIfKeepsMatchesInOrder)
+{
+	const Vector<std::uint32_t> v = MakeSequence(654321);
+	auto odd = [](std::uint32_t value) { return (value & 1) != 0; };
+
+	Vector<std::uint32_t> expected;
+	std::copy_if(v.begin(), v.end(), std::back_inserter(expected), odd);
+
+	EXPECT_TRUE(parallel_copy_if(v, odd) == expected);
+	EXPECT_TRUE(parallel_copy_if(v, [](std::uint32_t) { return false; }).empty());
+	EXPECT_TRUE(parallel_copy_if(Vector<std::uint32_t>(), odd).empty());
+}
+
+TEST(VectorParallelTests, GivenThrowingBody_ExceptionReachesTheCaller)
+{
+	Vector<int> v(200000);
+
+	EXPECT_THROW(parallel_for_each(v, [](int& value)
+	{
+		if (value == 0)
+		{
+			throw std::runtime_error("failed");
+		}
+	}), std::runtime_error);
+
+	// The pool is still usable afterwards, including from inside a loop.
+	std::atomic<std::size_t> total(0);
+	VectorThreadPool::instance().parallel_for(64, 1, [&](std::size_t begin, std::size_t end)
+	{
+		for (std::size_t i = begin; i < end; ++i)
+		{
+			total.fetch_add(parallel_reduce(MakeSequence(10000), 0) > 0 ? 1 : 0);
+		}
+	});
+	EXPECT_EQ(total.load(), 64);
+}
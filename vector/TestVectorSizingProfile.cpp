@@ -0,0 +1,162 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include "VectorSizingProfile.h"
+
+namespace
+{
+	void FillProfiledVector(const char* key, int count)
+	{
+		ProfiledVector<int> v(key);
+
+		for (int i = 0; i < count; ++i)
+		{
+			v.push_back(i);
+		}
+	}
+}
+
+TEST(VectorSizingProfileTests, GivenRecordedPeak_NextVectorStartsAtThatCapacity)
+{
+	VectorSizingProfile::reset();
+
+	FillProfiledVector("tokens", 1000);
+	EXPECT_EQ(VectorSizingProfile::hint("tokens"), 1000);
+	EXPECT_EQ(VectorSizingProfile::hint("unknown"), 0);
+
+	{
+		ProfiledVector<int> v("tokens");
+		EXPECT_EQ(v.capacity(), 0);
+
+		v.push_back(0);
+		EXPECT_EQ(v.capacity(), 1000);
+
+		const int* buffer = v.data();
+		for (int i = 1; i < 1000; ++i)
+		{
+			v.push_back(i);
+		}
+		EXPECT_EQ(v.data(), buffer);
+	}
+
+	// 2, 4, ..., 1024: ten allocations from empty, one with the hint.
+	const VectorSizingProfile::statistics stats = VectorSizingProfile::stats();
+	EXPECT_EQ(stats.vectors, 2);
+	EXPECT_EQ(stats.hintedVectors, 1);
+	EXPECT_EQ(stats.baselineAllocations, 20);
+	EXPECT_EQ(stats.growthAllocations, 11);
+}
+
+TEST(VectorSizingProfileTests, GivenHint_EmptyVectorAllocatesNothingAndLargerReserveAllocatesOnce)
+{
+	VectorSizingProfile::reset();
+	FillProfiledVector("lazy", 100);
+
+	{
+		ProfiledVector<int> unused("lazy");
+		EXPECT_EQ(unused.data(), nullptr);
+	}
+
+	{
+		ProfiledVector<int> v("lazy");
+		v.reserve(500);
+		EXPECT_EQ(v.capacity(), 500);
+
+		v.insert(v.cbegin(), 1);
+		EXPECT_EQ(v.capacity(), 500);
+		EXPECT_EQ(v.vector(), Vector<int>({ 1 }));
+	}
+
+	VectorSizingProfile::reset();
+}
+
+TEST(VectorSizingProfileTests, GivenClearedVector_PeakBeforeTheClearIsRecorded)
+{
+	VectorSizingProfile::reset();
+
+	{
+		ProfiledVector<int> v("frame");
+		v.assign(300, 1);
+		v.clear();
+		v.push_back(1);
+	}
+
+	EXPECT_EQ(VectorSizingProfile::hint("frame"), 300);
+}
+
+TEST(VectorSizingProfileTests, GivenSavedProfile_LoadRestoresTheHints)
+{
+	VectorSizingProfile::reset();
+	FillProfiledVector("parser nodes", 70);
+	FillProfiledVector("edges", 5);
+
+	const std::string path = (std::filesystem::temp_directory_path() / "vector_sizing_profile.txt").string();
+	ASSERT_TRUE(VectorSizingProfile::save(path.c_str()));
+
+	VectorSizingProfile::reset();
+	EXPECT_EQ(VectorSizingProfile::hint("edges"), 0);
+
+	ASSERT_TRUE(VectorSizingProfile::load(path.c_str()));
+	EXPECT_EQ(VectorSizingProfile::hint("parser nodes"), 70);
+	EXPECT_EQ(VectorSizingProfile::hint("edges"), 5);
+
+	std::remove(path.c_str());
+	EXPECT_FALSE(VectorSizingProfile::load(path.c_str()));
+	VectorSizingProfile::reset();
+}
+
+TEST(VectorSizingProfileTests, GivenMalformedLines_LoadSkipsOnlyThoseLines)
+{
+	VectorSizingProfile::reset();
+
+	const std::string path = (std::filesystem::temp_directory_path() / "vector_sizing_profile_malformed.txt").string();
+	{
+		std::ofstream file(path);
+		file << "10 a\nbogus line\n20 b\n30\n";
+	}
+
+	ASSERT_TRUE(VectorSizingProfile::load(path.c_str()));
+	EXPECT_EQ(VectorSizingProfile::hint("a"), 10);
+	EXPECT_EQ(VectorSizingProfile::hint("b"), 20);
+
+	std::remove(path.c_str());
+	VectorSizingProfile::reset();
+}
+
+TEST(VectorSizingProfileTests, GivenMovedVector_OnlyOneVectorIsRecorded)
+{
+	VectorSizingProfile::reset();
+
+	{
+		ProfiledVector<int> source(VECTOR_PROFILE_SITE("moved"));
+		source.assign(40, 1);
+
+		ProfiledVector<int> target(std::move(source));
+		EXPECT_STREQ(target.key(), "moved");
+	}
+
+	EXPECT_EQ(VectorSizingProfile::stats().vectors, 1);
+	EXPECT_EQ(VectorSizingProfile::hint("moved"), 40);
+	VectorSizingProfile::reset();
+}
+
+TEST(VectorSizingProfileTests, GivenCachedSite_VectorsShareTheSiteOfTheirKey)
+{
+	VectorSizingProfile::reset();
+
+	VectorSizingProfile::site& site = VectorSizingProfile::site_for("cached");
+	EXPECT_EQ(&site, &VectorSizingProfile::site_for("cached"));
+
+	for (int i = 0; i < 3; ++i)
+	{
+		ProfiledVector<int> v(VECTOR_PROFILE_SITE("cached"));
+		v.assign(25 * (i + 1), i);
+	}
+
+	EXPECT_EQ(site.hint(), 75);
+	EXPECT_EQ(VectorSizingProfile::stats().vectors, 3);
+	EXPECT_EQ(VectorSizingProfile::stats().hintedVectors, 2);
+	VectorSizingProfile::reset();
+}
@@ -0,0 +1,206 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include "VectorSort.h"
+
+// Sorts run on VectorThreadPool, which starts on first use; give it workers
+// even on a single core so that the parallel slices are exercised.
+static const bool sPoolConfigured = (VectorThreadPool::sMaximumThreads = 4, true);
+
+template<typename T, typename Distribution>
+static Vector<T> MakeRandomVector(std::size_t count, Distribution distribution)
+{
+	std::mt19937 random(1234);
+	Vector<T> v;
+	v.reserve(count);
+
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		v.push_back(static_cast<T>(distribution(random)));
+	}
+
+	return v;
+}
+
+TEST(VectorSortTests, GivenUnsignedIntegers_RadixSortMatchesStdSort)
+{
+	Vector<std::uint32_t> v = MakeRandomVector<std::uint32_t>(1000, std::uniform_int_distribution<std::uint32_t>());
+	Vector<std::uint32_t> expected(v);
+	std::sort(expected.begin(), expected.end());
+
+	parallel_sort(v);
+
+	EXPECT_TRUE(v == expected);
+}
+
+TEST(VectorSortTests, GivenSignedIntegers_NegativeValuesComeFirst)
+{
+	Vector<std::int64_t> v = { 5, -1, std::numeric_limits<std::int64_t>::min(), 0, std::numeric_limits<std::int64_t>::max(), -7 };
+
+	parallel_sort(v);
+
+	EXPECT_TRUE(std::is_sorted(v.begin(), v.end()));
+}
+
+TEST(VectorSortTests, GivenFloats_RadixSortOrdersNegativesZerosAndInfinities)
+{
+	const float infinity = std::numeric_limits<float>::infinity();
+	Vector<float> v = { 2.5f, -0.5f, infinity, 0.0f, -infinity, -3.0f, 1e-30f, -1e-30f };
+
+	parallel_sort(v);
+
+	EXPECT_TRUE(std::is_sorted(v.begin(), v.end()));
+	EXPECT_EQ(v.front(), -infinity);
+	EXPECT_EQ(v.back(), infinity);
+}
+
+TEST(VectorSortTests, GivenLargeInput_ParallelRadixSortMatchesStdSort)
+{
+	const std::size_t count = VectorSort::kMinimumElementsPerThread * 4 + 123;
+	Vector<double> v = MakeRandomVector<double>(count, std::normal_distribution<double>());
+	Vector<double> expected(v);
+	std::sort(expected.begin(), expected.end());
+
+	parallel_sort(v);
+
+	EXPECT_TRUE(v == expected);
+}
+
+TEST(VectorSortTests, GivenThreadPool_SortsSliceByItsThreadBudget)
+{
+	const std::size_t poolThreads = VectorThreadPool::instance().thread_count();
+
+	EXPECT_EQ(VectorSort::thread_count(VectorSort::kMinimumElementsPerThread * (poolThreads + 10)), poolThreads);
+	EXPECT_EQ(VectorSort::thread_count(VectorSort::kMinimumElementsPerThread - 1), 1);
+}
+
+TEST(VectorSortTests, GivenSpareCapacity_RadixSortAllocatesNothing)
+{
+	Vector<std::uint16_t> v = MakeRandomVector<std::uint16_t>(1000, std::uniform_int_distribution<int>(0, 65535));
+	v.reserve(2000);
+	const std::uint16_t* data = v.data();
+
+	parallel_sort(v);
+
+	EXPECT_EQ(v.data(), data);
+	EXPECT_EQ(v.capacity(), 2000);
+	EXPECT_TRUE(std::is_sorted(v.begin(), v.end()));
+}
+
+struct Record
+{
+	std::uint32_t id;
+	int payload;
+};
+
+TEST(VectorSortTests, GivenStructs_SortByKeyIsStableOnTheField)
+{
+	const int count = static_cast<int>(VectorSort::kMinimumElementsPerThread) * 2;
+	Vector<Record> v;
+	for (int i = 0; i < count; ++i)
+	{
+		v.push_back({ static_cast<std::uint32_t>((i * 7919) % 100), i });
+	}
+
+	parallel_sort_by_key(v, [](const Record& record) { return record.id; });
+
+	for (std::size_t i = 1; i < v.size(); ++i)
+	{
+		ASSERT_LE(v[i - 1].id, v[i].id);
+
+		if (v[i - 1].id == v[i].id)
+		{
+			EXPECT_LT(v[i - 1].payload, v[i].payload);
+		}
+	}
+}
+
+TEST(VectorSortTests, GivenNonTrivialElements_ParallelMergeSortIsStable)
+{
+	const std::size_t count = VectorSort::kMinimumElementsPerThread * 3 + 11;
+	Vector<std::pair<std::string, std::size_t>> v;
+	v.reserve(count);
+
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		v.push_back({ std::to_string((i * 7919) % 97), i });
+	}
+
+	parallel_sort_by_key(v, [](const std::pair<std::string, std::size_t>& element) { return element.first; });
+
+	for (std::size_t i = 1; i < v.size(); ++i)
+	{
+		ASSERT_LE(v[i - 1].first, v[i].first);
+
+		if (v[i - 1].first == v[i].first)
+		{
+			ASSERT_LT(v[i - 1].second, v[i].second);
+		}
+	}
+
+	parallel_sort(v, [](const auto& a, const auto& b) { return a.first.size() < b.first.size(); });
+
+	for (std::size_t i = 1; i < v.size(); ++i)
+	{
+		if (v[i - 1].first.size() == v[i].first.size())
+		{
+			ASSERT_LE(v[i - 1].first, v[i].first);
+		}
+	}
+}
+
+TEST(VectorSortTests, GivenThrowingKey_RadixSortFreesItsScratchBuffer)
+{
+	Vector<Record> v;
+	for (std::uint32_t i = 0; i < 100; ++i)
+	{
+		v.push_back(Record{ 99 - i, 0 });
+	}
+	v.shrink_to_fit();
+
+	static std::int64_t sOutstandingBytes = 0;
+	sOutstandingBytes = 0;
+	VectorAllocationHooks::onAllocate = [](void*, std::size_t bytes) { sOutstandingBytes += bytes; };
+	VectorAllocationHooks::onDeallocate = [](void*, std::size_t bytes) { sOutstandingBytes -= bytes; };
+
+	EXPECT_THROW(parallel_sort_by_key(v, [](const Record& record)
+	{
+		if (record.id == 7)
+		{
+			throw std::runtime_error("key");
+		}
+
+		return record.id;
+	}), std::runtime_error);
+
+	VectorAllocationHooks::onAllocate = nullptr;
+	VectorAllocationHooks::onDeallocate = nullptr;
+
+	EXPECT_EQ(sOutstandingBytes, 0);
+	EXPECT_EQ(v.size(), 100);
+}
+
+TEST(VectorSortTests, GivenStrings_ParallelMergeSortMatchesStdSort)
+{
+	const std::size_t count = VectorSort::kMinimumElementsPerThread * 3 + 7;
+	std::mt19937 random(99);
+	Vector<std::string> v;
+	v.reserve(count);
+
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		v.push_back(std::to_string(random()));
+	}
+
+	Vector<std::string> expected(v);
+	std::sort(expected.begin(), expected.end());
+
+	parallel_sort(v);
+	EXPECT_TRUE(v == expected);
+
+	parallel_sort(v, std::greater<std::string>());
+	EXPECT_TRUE(std::is_sorted(v.begin(), v.end(), std::greater<std::string>()));
+}
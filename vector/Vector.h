@@ -1,14 +1,163 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <stdexcept>
 #include <type_traits>
 #include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <utility>
+#include "VectorError.h"
+
+// Vector is usable in constant expressions when the standard library supports
+// constexpr allocation (C++20). Allocation then goes through std::allocator and
+// elements are copied one by one; at run time nothing changes.
+#if defined(__cpp_lib_constexpr_dynamic_alloc) && __cpp_lib_constexpr_dynamic_alloc >= 201907L
+#define VECTOR_CONSTEXPR constexpr
+#define VECTOR_HAS_CONSTEXPR_ALLOCATION 1
+#else
+#define VECTOR_CONSTEXPR
+#define VECTOR_HAS_CONSTEXPR_ALLOCATION 0
+#endif
+
+// Growth and error paths are kept out of line and off the hot path, so that
+// an inlined push_back is a compare, a store and an increment.
+#if defined(_MSC_VER) && !defined(__clang__)
+#define VECTOR_NOINLINE __declspec(noinline)
+#define VECTOR_UNLIKELY(condition) (condition)
+#else
+#define VECTOR_NOINLINE __attribute__((noinline, cold))
+#define VECTOR_UNLIKELY(condition) __builtin_expect(!!(condition), 0)
+#endif
+
+// VECTOR_ACCESS_POLICY sets how operator[], front() and back() check their
+// preconditions:
+//
+//   VECTOR_ACCESS_UNCHECKED  no checks.
+//   VECTOR_ACCESS_ASSERT     assert() in debug builds, no checks otherwise.
+//   VECTOR_ACCESS_CHECKED    report VectorError::OutOfRange or Range through
+//                            VectorErrorPolicy.
+//
+// Left undefined, front() and back() are checked and operator[] is not. at()
+// is always checked, since that is its contract.
+#define VECTOR_ACCESS_UNCHECKED 0
+#define VECTOR_ACCESS_ASSERT 1
+#define VECTOR_ACCESS_CHECKED 2
+
+#ifdef VECTOR_ACCESS_POLICY
+#define VECTOR_INDEX_ACCESS_POLICY VECTOR_ACCESS_POLICY
+#define VECTOR_END_ACCESS_POLICY VECTOR_ACCESS_POLICY
+#else
+#define VECTOR_INDEX_ACCESS_POLICY VECTOR_ACCESS_UNCHECKED
+#define VECTOR_END_ACCESS_POLICY VECTOR_ACCESS_CHECKED
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+/// VectorAllocationHooks
+///
+/// Optional callbacks invoked for every run-time allocation and deallocation of
+/// Vector storage, for tests and tools that count or trace memory traffic.
+/// Install them before any Vector is used concurrently; while unset they cost
+/// one pointer load per allocation.
+///
+/// reuse and recycle let a buffer cache such as VectorBufferPool (see
+/// VectorBufferPool.h) take part: reuse may serve an allocation from a buffer
+/// it kept, and recycle may keep a buffer instead of freeing it, returning
+/// nullptr or false to let the allocation or deallocation proceed as usual.
+/// onAllocate and onDeallocate don't see buffers that stay in the cache.
+/// release may take over freeing a buffer that onDeallocate has seen, for
+/// example to free it on another thread as VectorReclaimer does (see
+/// VectorReclaimer.h), returning false to let Vector free it.
+///
+struct VectorAllocationHooks
+{
+	typedef void (*callback)(void* memory, std::size_t bytes);
+	typedef void* (*reuse_callback)(std::size_t bytes, std::size_t alignment);
+	typedef bool (*recycle_callback)(void* memory, std::size_t bytes);
+	typedef bool (*release_callback)(void* memory, std::size_t bytes);
+
+	static inline callback onAllocate = nullptr;
+	static inline callback onDeallocate = nullptr;
+
+	static inline reuse_callback reuse = nullptr;
+	static inline recycle_callback recycle = nullptr;
+	static inline release_callback release = nullptr;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+/// Deleter policies
+///
+/// Decide which buffers a Vector can adopt() and how it frees them.
+///
+/// VectorDefaultDeleter - the Vector only holds buffers from allocate_buffer
+///                        and frees them with deallocate_buffer. adopt() takes
+///                        no deleter, and the policy takes no space.
+/// VectorCustomDeleter  - adopt() also takes buffers from foreign code along
+///                        with the function that frees them. The Vector keeps
+///                        that deleter next to the buffer, one more word, and
+///                        calls it when it lets go of the buffer; buffers it
+///                        allocates itself are freed as usual.
+///
+struct VectorDefaultDeleter {};
+struct VectorCustomDeleter {};
+
+template<typename Deleter, typename Function>
+class VectorDeleterStorage
+{
+protected:
+	static constexpr Function stored_deleter() noexcept
+	{
+		return nullptr;
+	}
+
+	constexpr void store_deleter(Function) noexcept
+	{
+	}
+};
+
+template<typename Function>
+class VectorDeleterStorage<VectorCustomDeleter, Function>
+{
+protected:
+	constexpr Function stored_deleter() const noexcept
+	{
+		return _deleter;
+	}
 
-template<typename T>
-class Vector
+	constexpr void store_deleter(Function deleter) noexcept
+	{
+		_deleter = deleter;
+	}
+
+private:
+	Function _deleter = nullptr;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+/// Vector
+///
+/// SizeType is the unsigned type used to store the size and capacity. The
+/// default std::size_t makes a Vector three words; std::uint32_t packs size
+/// and capacity into one word (16 bytes on 64-bit targets) for containers of
+/// many small vectors, at the cost of a max_size() of 4G - 1 elements. Growth
+/// beyond max_size() throws std::length_error.
+///
+/// Deleter is one of the deleter policies above; only VectorCustomDeleter can
+/// adopt() a buffer that has to be freed some other way.
+///
+template<typename T, typename SizeType = std::size_t, typename Deleter = VectorDefaultDeleter>
+class Vector : private VectorDeleterStorage<Deleter, void (*)(T*, SizeType)>
 {
+	static_assert(std::is_unsigned_v<SizeType>, "Vector size type must be an unsigned integer");
+
 public:
-	typedef                    std::size_t size_type;
+	typedef                    SizeType size_type;
 	typedef                    std::ptrdiff_t difference_type;
 
 	typedef                    T value_type;
@@ -22,72 +171,172 @@ public:
 	typedef                    T* pointer;
 	typedef const              T* const_pointer;
 
+private:
+	// Only iterators have a category, so this keeps the iterator overloads
+	// away from calls like assign(3, 7).
+	template<typename Iterator>
+	using iterator_category_t = typename std::iterator_traits<Iterator>::iterator_category;
+
 public:
-	Vector() noexcept;
-	explicit Vector(size_type count);
-	Vector(const Vector<T>& other);
-	Vector(Vector<T>&& other) noexcept (std::is_nothrow_move_constructible_v<T>);
-	Vector(std::initializer_list<T> ilist);
-	~Vector();
-	Vector<T>& operator=(const Vector<T>& other);
-	Vector<T>& operator=(Vector<T>&& other) noexcept(std::is_nothrow_move_assignable_v<T>);
-	Vector<T>& operator=(std::initializer_list<T> ilist);
+	VECTOR_CONSTEXPR Vector() noexcept;
+	VECTOR_CONSTEXPR explicit Vector(std::size_t count);
+	template<typename InputIterator, typename = iterator_category_t<InputIterator>>
+	VECTOR_CONSTEXPR Vector(InputIterator first, InputIterator last);
+	VECTOR_CONSTEXPR Vector(const Vector<T, SizeType, Deleter>& other);
+	VECTOR_CONSTEXPR Vector(Vector<T, SizeType, Deleter>&& other) noexcept (std::is_nothrow_move_constructible_v<T>);
+	VECTOR_CONSTEXPR Vector(std::initializer_list<T> ilist);
+	VECTOR_CONSTEXPR ~Vector();
+	VECTOR_CONSTEXPR Vector<T, SizeType, Deleter>& operator=(const Vector<T, SizeType, Deleter>& other);
+	VECTOR_CONSTEXPR Vector<T, SizeType, Deleter>& operator=(Vector<T, SizeType, Deleter>&& other) noexcept(std::is_nothrow_move_assignable_v<T>);
+	VECTOR_CONSTEXPR Vector<T, SizeType, Deleter>& operator=(std::initializer_list<T> ilist);
 
 public:
 	template<class... Args>
-	reference emplace_back(Args&& ... args);
-
-	void push_back(const T& element);
-	void push_back(T&& element);
+	VECTOR_CONSTEXPR reference emplace_back(Args&& ... args);
 
-	iterator insert(iterator pos, const T& value);
-	iterator insert(iterator pos, T&& value);
+	VECTOR_CONSTEXPR void push_back(const T& element);
+	VECTOR_CONSTEXPR void push_back(T&& element);
 
-	iterator erase(iterator pos);
-	const_iterator erase(const_iterator pos);
-	iterator erase(iterator pos, iterator last);
+	VECTOR_CONSTEXPR iterator insert(const_iterator pos, const T& value);
+	VECTOR_CONSTEXPR iterator insert(const_iterator pos, T&& value);
 
-	reference operator[](const size_t n) noexcept;
-	const_reference operator[](const size_t n) const noexcept;
-
-	reference at(const size_type n);
-	const_reference at(const size_type n) const;
+	template<class... Args>
+	VECTOR_CONSTEXPR iterator emplace(const_iterator pos, Args&& ... args);
+
+	VECTOR_CONSTEXPR iterator erase(iterator pos);
+	VECTOR_CONSTEXPR const_iterator erase(const_iterator pos);
+	VECTOR_CONSTEXPR iterator erase(iterator pos, iterator last);
+
+	/// Bulk operations check the capacity once and reallocate at most once when
+	/// the length of the range is known up front (forward iterators), and copy
+	/// trivially copyable elements from pointer ranges with memcpy. A failed
+	/// append leaves the Vector as it was.
+	template<typename InputIterator, typename = iterator_category_t<InputIterator>>
+	VECTOR_CONSTEXPR void assign(InputIterator first, InputIterator last);
+	VECTOR_CONSTEXPR void assign(const std::size_t count, const T& value);
+
+	template<typename InputIterator, typename = iterator_category_t<InputIterator>>
+	VECTOR_CONSTEXPR void append(InputIterator first, InputIterator last);
+	template<typename Range>
+	VECTOR_CONSTEXPR void append(const Range& range);
+	/// Moves the elements of other to the end and leaves other empty; if *this
+	/// is empty it takes other's buffer instead. Appending a Vector to itself
+	/// copies its elements after themselves.
+	VECTOR_CONSTEXPR void append(Vector<T, SizeType, Deleter>&& other);
+
+	/// Appends count elements constructed from generator().
+	template<typename Generator>
+	VECTOR_CONSTEXPR void generate_back(const std::size_t count, Generator generator);
+
+	/// Counts and indices are taken as std::size_t and checked before they are
+	/// narrowed to size_type, so a narrow SizeType never silently truncates them.
+	VECTOR_CONSTEXPR reference operator[](const std::size_t n) noexcept(VECTOR_INDEX_ACCESS_POLICY != VECTOR_ACCESS_CHECKED);
+	VECTOR_CONSTEXPR const_reference operator[](const std::size_t n) const noexcept(VECTOR_INDEX_ACCESS_POLICY != VECTOR_ACCESS_CHECKED);
+
+	VECTOR_CONSTEXPR reference at(const std::size_t n);
+	VECTOR_CONSTEXPR const_reference at(const std::size_t n) const;
 
 public:
-	bool validate() const noexcept;
-	bool empty() const noexcept;
-	size_type size() const noexcept;
-	size_type capacity() const noexcept;
-	void reserve(const size_type newCapacity);
-	void clear() noexcept;
+	VECTOR_CONSTEXPR bool validate() const noexcept;
+	VECTOR_CONSTEXPR bool empty() const noexcept;
+	VECTOR_CONSTEXPR size_type size() const noexcept;
+	VECTOR_CONSTEXPR size_type capacity() const noexcept;
+	static constexpr size_type max_size() noexcept;
+	VECTOR_CONSTEXPR void reserve(const std::size_t newCapacity);
+
+	/// Destroys the elements but keeps the buffer, so refilling the Vector up
+	/// to its previous size allocates nothing.
+	VECTOR_CONSTEXPR void clear() noexcept;
+
+	/// Reduces the capacity to max(size(), newCapacity); a no-op if it is
+	/// already that small. shrink_to_fit() is shrink_to(0), and after a
+	/// clear() it gives the whole buffer back.
+	VECTOR_CONSTEXPR void shrink_to(const std::size_t newCapacity);
+	VECTOR_CONSTEXPR void shrink_to_fit();
 
 public:
-	iterator                   begin() noexcept;
-	const_iterator             begin() const noexcept;
-	const_iterator             cbegin() const noexcept;
+	VECTOR_CONSTEXPR iterator                   begin() noexcept;
+	VECTOR_CONSTEXPR const_iterator             begin() const noexcept;
+	VECTOR_CONSTEXPR const_iterator             cbegin() const noexcept;
 
-	iterator                   end() noexcept;
-	const_iterator             end() const noexcept;
-	const_iterator             cend() const noexcept;
+	VECTOR_CONSTEXPR iterator                   end() noexcept;
+	VECTOR_CONSTEXPR const_iterator             end() const noexcept;
+	VECTOR_CONSTEXPR const_iterator             cend() const noexcept;
 
-	reference                  front();
-	const_reference            front() const;
+	VECTOR_CONSTEXPR reference                  front();
+	VECTOR_CONSTEXPR const_reference            front() const;
 
-	reference                  back();
-	const_reference            back() const;
+	VECTOR_CONSTEXPR reference                  back();
+	VECTOR_CONSTEXPR const_reference            back() const;
 
-	pointer                    data() noexcept;
-	const_pointer              data() const noexcept;
+	VECTOR_CONSTEXPR pointer                    data() noexcept;
+	VECTOR_CONSTEXPR const_pointer              data() const noexcept;
+
+public:
+	typedef void (*buffer_deleter)(T* container, size_type capacity);
+
+	/// A raw buffer handed over by release(). Elements [data, data + size) are
+	/// constructed; deleter frees the memory without destroying them.
+	struct buffer_type
+	{
+		pointer data;
+		size_type size;
+		size_type capacity;
+		buffer_deleter deleter;
+	};
+
+	/// Takes over a buffer holding size constructed elements. Without a deleter
+	/// the buffer must come from allocate_buffer; with one, which needs the
+	/// VectorCustomDeleter policy, the deleter is called once the Vector lets go
+	/// of the buffer.
+	void adopt(pointer container, const size_type size, const size_type capacity);
+	template<typename D = Deleter, typename = std::enable_if_t<std::is_same_v<D, VectorCustomDeleter>>>
+	void adopt(pointer container, const size_type size, const size_type capacity, buffer_deleter deleter);
+	buffer_type release();
+
+	static pointer allocate_buffer(const size_type capacity);
+	static void deallocate_buffer(pointer container, const size_type capacity) noexcept;
 
 private:
-	void reallocate(const size_type desiredCapacity);
-	void resize();
-	void swap(Vector<T>& other) noexcept;
-	void memcopy_trivially(T* src, T* dest, const size_type size);
+	VECTOR_CONSTEXPR void reallocate(const size_type desiredCapacity);
+	VECTOR_CONSTEXPR void destroy_storage() noexcept;
+	VECTOR_CONSTEXPR void deallocate_container() noexcept;
+	VECTOR_CONSTEXPR void swap(Vector<T, SizeType, Deleter>& other) noexcept;
+	VECTOR_CONSTEXPR void assign_in_place(const Vector<T, SizeType, Deleter>& other) noexcept;
 	template<class... Args>
-	void emplace_back_internal(Args&& ... element);
+	VECTOR_CONSTEXPR void emplace_back_internal(Args&& ... element);
+	// The growth slow path of emplace_back. The new element is built in the new
+	// buffer first, so arguments referring to an element stay valid. Defined in
+	// the class because GCC warns about a constexpr (so inline) definition
+	// following a noinline declaration.
+	template<class... Args>
+	VECTOR_NOINLINE VECTOR_CONSTEXPR void emplace_back_grow(Args&& ... args)
+	{
+		emplace_reallocate(_size, std::forward<Args>(args)...);
+	}
+	template<class... U>
+	VECTOR_CONSTEXPR iterator emplace_internal(const_iterator pos, U&& ... value);
 	template<class... U>
-	void emplace_internal(iterator pos, U&& ... value);
+	VECTOR_CONSTEXPR void emplace_reallocate(const size_type positionIndex, U&& ... value);
+	template<class... U>
+	VECTOR_CONSTEXPR void emplace_shift_by_copy(const size_type positionIndex, U&& ... value);
+	template<typename InputIterator>
+	VECTOR_CONSTEXPR void append_range(InputIterator first, InputIterator last);
+	VECTOR_CONSTEXPR static void relocate(T* first, T* last, T* dest);
+
+	static constexpr bool constant_evaluated() noexcept;
+	template<int Policy>
+	VECTOR_CONSTEXPR static void check_access(const bool valid, const VectorError error, const char* message) noexcept(Policy != VECTOR_ACCESS_CHECKED);
+	VECTOR_CONSTEXPR static size_type checked_size(const std::size_t count);
+	VECTOR_CONSTEXPR static size_type grown_capacity(const size_type capacity);
+	VECTOR_CONSTEXPR static T* allocate_storage(const size_type capacity);
+	VECTOR_CONSTEXPR static void deallocate_storage(T* container, const size_type capacity) noexcept;
+	template<class... Args>
+	VECTOR_CONSTEXPR static void construct_element(T* position, Args&& ... args);
+	template<typename InputIterator>
+	VECTOR_CONSTEXPR static void copy_construct_range(InputIterator first, InputIterator last, T* dest);
+	VECTOR_CONSTEXPR static void value_construct_range(T* first, const size_type count);
+	VECTOR_CONSTEXPR static void fill_construct_range(T* first, const size_type count, const T& value);
 
 private:
 	size_type _size;
@@ -95,8 +344,8 @@ private:
 	T* _container;
 };
 
-template<typename T>
-Vector<T>::Vector() noexcept
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR Vector<T, SizeType, Deleter>::Vector() noexcept
 	:
 	_size(0),
 	_capacity(0),
@@ -104,548 +353,1344 @@ Vector<T>::Vector() noexcept
 {
 }
 
-template<typename T>
-Vector<T>::Vector(size_type count)
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR Vector<T, SizeType, Deleter>::Vector(std::size_t count)
+	:
+	_size(checked_size(count)),
+	_capacity(_size),
+	_container(allocate_storage(_size))
+{
+	VECTOR_TRY
+	{
+		value_construct_range(_container, _size);
+	}
+	VECTOR_CATCH_ALL
+	{
+		deallocate_storage(_container, _capacity);
+		VECTOR_RETHROW;
+	}
+}
+
+template<typename T, typename SizeType, typename Deleter>
+template<typename InputIterator, typename>
+VECTOR_CONSTEXPR Vector<T, SizeType, Deleter>::Vector(InputIterator first, InputIterator last)
 	:
-	_size(count),
-	_capacity(count),
-	_container(static_cast<T*>(_aligned_malloc(sizeof(T)* count, alignof(T))))
+	Vector()
 {
-	std::uninitialized_value_construct_n(_container, count);
+	if constexpr (std::is_base_of_v<std::forward_iterator_tag, iterator_category_t<InputIterator>>)
+	{
+		reserve(checked_size(static_cast<std::size_t>(std::distance(first, last))));
+	}
+
+	append_range(first, last);
 }
 
-template<typename T>
-Vector<T>::Vector(const Vector<T>& other)
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR Vector<T, SizeType, Deleter>::Vector(const Vector<T, SizeType, Deleter>& other)
 	:
 	_size(other._size),
 	_capacity(other._size),
-	_container(static_cast<T*>(_aligned_malloc(sizeof(T)* other._size, alignof(T))))
+	_container(allocate_storage(other._size))
 {
-	if constexpr (std::is_trivially_copyable_v<T>)
+	VECTOR_TRY
 	{
-		memcopy_trivially(_container, other._container, other._size);
+		copy_construct_range(other.begin(), other.end(), _container);
 	}
-	else
+	VECTOR_CATCH_ALL
 	{
-		std::uninitialized_copy(other.begin(), other.end(), _container);
+		deallocate_storage(_container, _capacity);
+		VECTOR_RETHROW;
 	}
 }
 
-template<typename T>
-Vector<T>::Vector(Vector<T>&& other) noexcept (std::is_nothrow_move_constructible_v<T>)
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR Vector<T, SizeType, Deleter>::Vector(Vector<T, SizeType, Deleter>&& other) noexcept (std::is_nothrow_move_constructible_v<T>)
 	:
 	_size(other._size),
 	_capacity(other._capacity),
 	_container(other._container)
 {
+	this->store_deleter(other.stored_deleter());
+
 	other._size = 0;
 	other._capacity = 0;
 	other._container = nullptr;
+	other.store_deleter(nullptr);
 }
 
-template<typename T>
-inline Vector<T>::Vector(std::initializer_list<value_type> ilist)
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR inline Vector<T, SizeType, Deleter>::Vector(std::initializer_list<value_type> ilist)
 	:
 	_size(0),
-	_capacity(ilist.size()),
-	_container(static_cast<T*>(_aligned_malloc(sizeof(value_type)* ilist.size(), alignof(value_type))))
+	_capacity(checked_size(ilist.size())),
+	_container(allocate_storage(_capacity))
 {
-	for (_size = 0; _size < ilist.size(); _size += 1)
+	VECTOR_TRY
 	{
-		emplace_back_internal(*(ilist.begin() + _size));
+		copy_construct_range(ilist.begin(), ilist.end(), _container);
 	}
+	VECTOR_CATCH_ALL
+	{
+		deallocate_storage(_container, _capacity);
+		VECTOR_RETHROW;
+	}
+
+	_size = _capacity;
 }
 
-template<typename T>
-Vector<T>::~Vector()
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR Vector<T, SizeType, Deleter>::~Vector()
 {
-	clear();
+	destroy_storage();
 }
 
-template<typename T>
-Vector<T>& Vector<T>::operator=(const Vector<T>& other)
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR Vector<T, SizeType, Deleter>& Vector<T, SizeType, Deleter>::operator=(const Vector<T, SizeType, Deleter>& other)
 {
-	Vector<T> tmp(other);
+	if (this == &other)
+	{
+		return *this;
+	}
+
+	// Copying over the existing buffer can't be undone if an element copy throws,
+	// so it is only taken when the copies can't throw. Otherwise fall back to
+	// copy-and-swap for the strong guarantee.
+	if constexpr (std::is_nothrow_copy_constructible_v<T> && std::is_nothrow_copy_assignable_v<T>)
+	{
+		if (_capacity >= other._size)
+		{
+			assign_in_place(other);
+
+			return *this;
+		}
+	}
+
+	Vector<T, SizeType, Deleter> tmp(other);
 	tmp.swap(*this);
 
 	return *this;
 }
 
-template<typename T>
-Vector<T>& Vector<T>::operator=(Vector<T>&& other) noexcept(std::is_nothrow_move_assignable_v<T>)
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR Vector<T, SizeType, Deleter>& Vector<T, SizeType, Deleter>::operator=(Vector<T, SizeType, Deleter>&& other) noexcept(std::is_nothrow_move_assignable_v<T>)
 {
 	other.swap(*this);
 
 	return *this;
 }
 
-template<typename T>
-inline Vector<T>& Vector<T>::operator=(std::initializer_list<value_type> ilist)
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR inline Vector<T, SizeType, Deleter>& Vector<T, SizeType, Deleter>::operator=(std::initializer_list<value_type> ilist)
 {
-	if constexpr (!std::is_trivially_destructible_v<T>)
+	assign(ilist.begin(), ilist.end());
+
+	return *this;
+}
+
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR inline void Vector<T, SizeType, Deleter>::push_back(const T& element)
+{
+	emplace_back(element);
+}
+
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR inline void Vector<T, SizeType, Deleter>::push_back(T&& element)
+{
+	emplace_back(std::move(element));
+}
+
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR typename Vector<T, SizeType, Deleter>::iterator
+Vector<T, SizeType, Deleter>::insert(const_iterator pos, const T& value)
+{
+	return emplace_internal(pos, value);
+}
+
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR typename Vector<T, SizeType, Deleter>::iterator
+Vector<T, SizeType, Deleter>::insert(const_iterator pos, T&& value)
+{
+	return emplace_internal(pos, std::move(value));
+}
+
+template<typename T, typename SizeType, typename Deleter>
+template<class... Args>
+VECTOR_CONSTEXPR typename Vector<T, SizeType, Deleter>::iterator
+Vector<T, SizeType, Deleter>::emplace(const_iterator pos, Args&& ... args)
+{
+	return emplace_internal(pos, std::forward<Args>(args)...);
+}
+
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR typename Vector<T, SizeType, Deleter>::iterator
+Vector<T, SizeType, Deleter>::erase(iterator position)
+{
+	if (position < begin() || position >= end())
 	{
-		std::destroy(begin(), end());
+		VectorErrorPolicy::raise(VectorError::OutOfRange, "Vector::erase -- out of range");
 	}
 
-	_size = 0;
+	std::move(position + 1, end(), position);
 
-	if (_capacity < ilist.size())
-	{
-		_aligned_free(_container);
+	(end() - 1)->~T();
+	_size -= 1;
+
+	return position;
+}
 
-		_container = static_cast<T*>(_aligned_malloc(sizeof(value_type) * ilist.size(), alignof(value_type)));
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR typename Vector<T, SizeType, Deleter>::const_iterator
+Vector<T, SizeType, Deleter>::erase(const_iterator position)
+{
+	return erase(const_cast<iterator>(position));
+}
 
-		_capacity = ilist.size();
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR typename Vector<T, SizeType, Deleter>::iterator
+Vector<T, SizeType, Deleter>::erase(iterator first, iterator last)
+{
+	if (first > last || first < begin() || first > end() || last < begin() || last > end())
+	{
+		VectorErrorPolicy::raise(VectorError::OutOfRange, "Vector::erase(first, last) -- out of range");
 	}
 
-	for (_size = 0; _size < ilist.size(); _size += 1)
+	if (first == last)
 	{
-		emplace_back_internal(*(ilist.begin() + _size));
+		return begin();
 	}
 
-	return *this;
+	size_type elementsToRemoveCnt = static_cast<size_type>(std::distance(first, last));
+
+	auto position = std::move(last, end(), first);
+
+	std::destroy(position, end());
+
+	_size -= elementsToRemoveCnt;
+
+	return first;
 }
 
-template<typename T>
-void Vector<T>::push_back(const T& element)
+template<typename T, typename SizeType, typename Deleter>
+template<class... Args>
+VECTOR_CONSTEXPR inline typename Vector<T, SizeType, Deleter>::reference
+Vector<T, SizeType, Deleter>::emplace_back(Args&& ... args)
 {
-	if (_size == _capacity)
+	if (VECTOR_UNLIKELY(_size == _capacity))
+	{
+		emplace_back_grow(std::forward<Args>(args)...);
+	}
+	else
 	{
-		resize();
+		emplace_back_internal(std::forward<Args>(args)...);
 	}
 
-	emplace_back_internal(element);
 	_size += 1;
+
+	return _container[_size - 1];
 }
 
-template<typename T>
-void Vector<T>::push_back(T&& element)
+
+template<typename T, typename SizeType, typename Deleter>
+template<typename InputIterator, typename>
+VECTOR_CONSTEXPR void Vector<T, SizeType, Deleter>::assign(InputIterator first, InputIterator last)
 {
-	if (_size == _capacity)
+	if constexpr (std::is_base_of_v<std::forward_iterator_tag, iterator_category_t<InputIterator>>)
 	{
-		resize();
+		const size_type count = checked_size(static_cast<std::size_t>(std::distance(first, last)));
+
+		if (count > _capacity)
+		{
+			T* newContainer = allocate_storage(count);
+
+			VECTOR_TRY
+			{
+				copy_construct_range(first, last, newContainer);
+			}
+			VECTOR_CATCH_ALL
+			{
+				deallocate_storage(newContainer, count);
+				VECTOR_RETHROW;
+			}
+
+			destroy_storage();
+
+			_container = newContainer;
+			_size = count;
+			_capacity = count;
+
+			return;
+		}
 	}
 
-	emplace_back_internal(std::forward<T>(element));
-	_size += 1;
+	clear();
+	append_range(first, last);
 }
 
-template<typename T>
-typename Vector<T>::iterator
-Vector<T>::insert(iterator pos, const T& value)
+// Elements that are kept are assigned rather than rebuilt, so value may refer
+// to one of them.
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR void Vector<T, SizeType, Deleter>::assign(const std::size_t newCount, const T& value)
 {
-	emplace_internal(pos, value);
+	const size_type count = checked_size(newCount);
 
-	_size += 1;
+	if (count > _capacity)
+	{
+		const size_type newCapacity = count;
+		T* newContainer = allocate_storage(newCapacity);
+
+		VECTOR_TRY
+		{
+			fill_construct_range(newContainer, count, value);
+		}
+		VECTOR_CATCH_ALL
+		{
+			deallocate_storage(newContainer, newCapacity);
+			VECTOR_RETHROW;
+		}
+
+		destroy_storage();
+
+		_container = newContainer;
+		_size = count;
+		_capacity = newCapacity;
+
+		return;
+	}
+
+	std::fill_n(begin(), std::min(_size, count), value);
+
+	if (count > _size)
+	{
+		fill_construct_range(end(), count - _size, value);
+	}
+	else
+	{
+		std::destroy(begin() + count, end());
+	}
 
-	return pos;
+	_size = count;
 }
 
-template<typename T>
-typename Vector<T>::iterator
-Vector<T>::insert(iterator pos, T&& value)
+template<typename T, typename SizeType, typename Deleter>
+template<typename InputIterator, typename>
+VECTOR_CONSTEXPR inline void Vector<T, SizeType, Deleter>::append(InputIterator first, InputIterator last)
 {
-	emplace_internal(pos, std::move(value));
-
-	_size += 1;
+	append_range(first, last);
+}
 
-	return pos;
+template<typename T, typename SizeType, typename Deleter>
+template<typename Range>
+VECTOR_CONSTEXPR inline void Vector<T, SizeType, Deleter>::append(const Range& range)
+{
+	append_range(std::begin(range), std::end(range));
 }
 
-template<typename T>
-typename Vector<T>::iterator
-Vector<T>::erase(iterator position)
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR void Vector<T, SizeType, Deleter>::append(Vector<T, SizeType, Deleter>&& other)
 {
-	if (position < begin() || position >= end())
+	if (this == &other)
 	{
-		throw std::out_of_range("Vector::erase -- out of range");
+		append_range(std::as_const(*this).begin(), std::as_const(*this).end());
+
+		return;
 	}
 
-	std::move(position + 1, end(), position);
+	if (empty())
+	{
+		destroy_storage();
 
-	back().~T();
-	_size -= 1;
+		_container = std::exchange(other._container, nullptr);
+		_size = std::exchange(other._size, 0);
+		_capacity = std::exchange(other._capacity, 0);
+		this->store_deleter(other.stored_deleter());
+		other.store_deleter(nullptr);
 
-	return position;
+		return;
+	}
+
+	if constexpr (std::is_trivially_copyable_v<T>)
+	{
+		append_range(std::as_const(other).begin(), std::as_const(other).end());
+	}
+	else
+	{
+		append_range(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+	}
+
+	other.clear();
 }
 
-template<typename T>
-typename Vector<T>::const_iterator
-Vector<T>::erase(const_iterator position)
+template<typename T, typename SizeType, typename Deleter>
+template<typename Generator>
+VECTOR_CONSTEXPR void Vector<T, SizeType, Deleter>::generate_back(const std::size_t count, Generator generator)
 {
-	return erase(const_cast<iterator>(position));
+	const size_type newSize = checked_size(static_cast<std::size_t>(_size) + count);
+
+	if (newSize > _capacity)
+	{
+		reserve(std::max(newSize, grown_capacity(_capacity)));
+	}
+
+	const size_type oldSize = _size;
+
+	VECTOR_TRY
+	{
+		for (; _size < newSize; _size += 1)
+		{
+			emplace_back_internal(generator());
+		}
+	}
+	VECTOR_CATCH_ALL
+	{
+		std::destroy(begin() + oldSize, end());
+		_size = oldSize;
+		VECTOR_RETHROW;
+	}
 }
 
-template<typename T>
-typename Vector<T>::iterator
-Vector<T>::erase(iterator first, iterator last)
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR void Vector<T, SizeType, Deleter>::clear() noexcept
 {
-	if (first > last || first < begin() || first > end() || last < begin() || last > end())
+	if constexpr (!std::is_trivially_destructible_v<T>)
 	{
-		throw std::out_of_range("Vector::erase(first, last) -- out of range");
+		std::destroy(begin(), end());
 	}
 
-	if (first == last)
+	_size = 0;
+}
+
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR void Vector<T, SizeType, Deleter>::shrink_to(const std::size_t newCapacity)
+{
+	if (newCapacity >= _capacity)
 	{
-		return begin();
+		return;
 	}
 
-	size_type elementsToRemoveCnt = std::distance(first, last);
+	const size_type desiredCapacity = std::max(_size, static_cast<size_type>(newCapacity));
 
-	auto position = std::move(last, end(), first);
+	if (desiredCapacity >= _capacity)
+	{
+		return;
+	}
 
-	std::destroy(position, end());
+	if (desiredCapacity == 0)
+	{
+		deallocate_container();
 
-	_size -= elementsToRemoveCnt;
+		_container = nullptr;
+		_capacity = 0;
+	}
+	else
+	{
+		reallocate(desiredCapacity);
+	}
+}
 
-	return first;
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR inline void Vector<T, SizeType, Deleter>::shrink_to_fit()
+{
+	shrink_to(0);
 }
 
-template<typename T>
-template<class... Args>
-inline typename Vector<T>::reference
-Vector<T>::emplace_back(Args&& ... args)
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR inline void Vector<T, SizeType, Deleter>::reallocate(const size_type desiredCapacity)
 {
-	if (_size == _capacity)
+	T* newContainer = allocate_storage(desiredCapacity);
+
+	VECTOR_TRY
+	{
+		relocate(begin(), end(), newContainer);
+	}
+	VECTOR_CATCH_ALL
 	{
-		resize();
+		deallocate_storage(newContainer, desiredCapacity);
+		VECTOR_RETHROW;
 	}
 
-	emplace_back_internal(std::move(args)...);
-	_size += 1;
+	destroy_storage();
 
-	return back();
+	_container = newContainer;
+	_capacity = desiredCapacity;
 }
 
-template<typename T>
-void Vector<T>::clear() noexcept
+// Destroys the elements and frees the buffer without touching the members;
+// callers either install a new buffer or are about to go away.
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR inline void Vector<T, SizeType, Deleter>::destroy_storage() noexcept
 {
 	if constexpr (!std::is_trivially_destructible_v<T>)
 	{
 		std::destroy(begin(), end());
 	}
 
-	_aligned_free(_container);
+	deallocate_container();
 }
 
-template<typename T>
-std::enable_if_t<std::is_nothrow_move_constructible_v<T>> uninitialized_move_or_copy(T* first, T* last, T* dest)
+// Frees the buffer with the deleter it was adopted with, if any, and forgets
+// that deleter, since whatever buffer comes next is the Vector's own.
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR inline void Vector<T, SizeType, Deleter>::deallocate_container() noexcept
 {
-	std::uninitialized_move(first, last, dest);
+	if (buffer_deleter deleter = this->stored_deleter())
+	{
+		this->store_deleter(nullptr);
+		deleter(_container, _capacity);
+
+		return;
+	}
+
+	deallocate_storage(_container, _capacity);
 }
 
-template<typename T>
-std::enable_if_t<std::is_copy_constructible_v<T> && !std::is_nothrow_move_constructible_v<T>> uninitialized_move_or_copy(T* first, T* last, T* dest)
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR inline void Vector<T, SizeType, Deleter>::swap(Vector<T, SizeType, Deleter>& other) noexcept
 {
-	try
+	std::swap(_size, other._size);
+	std::swap(_capacity, other._capacity);
+	std::swap(_container, other._container);
+
+	buffer_deleter deleter = this->stored_deleter();
+	this->store_deleter(other.stored_deleter());
+	other.store_deleter(deleter);
+}
+
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR void Vector<T, SizeType, Deleter>::assign_in_place(const Vector<T, SizeType, Deleter>& other) noexcept
+{
+	if constexpr (std::is_trivially_copyable_v<T>)
 	{
-		std::uninitialized_copy(first, last, dest);
+		if (!constant_evaluated())
+		{
+			if (other._size != 0)
+			{
+				std::memcpy(static_cast<void*>(_container), other._container, other._size * sizeof(T));
+			}
+
+			_size = other._size;
+
+			return;
+		}
 	}
-	catch (...)
+
+	const size_type assignedCount = std::min(_size, other._size);
+
+	std::copy(other.begin(), other.begin() + assignedCount, begin());
+
+	if (other._size > _size)
+	{
+		copy_construct_range(other.begin() + assignedCount, other.end(), end());
+	}
+	else
 	{
-		_aligned_free(dest);
-		throw;
+		std::destroy(begin() + assignedCount, end());
 	}
+
+	_size = other._size;
 }
 
-template<typename T>
-inline void Vector<T>::reallocate(const size_type desiredCapacity)
+template<typename T, typename SizeType, typename Deleter>
+template<class... U>
+VECTOR_CONSTEXPR typename Vector<T, SizeType, Deleter>::iterator
+Vector<T, SizeType, Deleter>::emplace_internal(const_iterator pos, U&& ... value)
 {
-	_capacity = desiredCapacity;
+	if (pos < begin() || pos > end())
+	{
+		VectorErrorPolicy::raise(VectorError::OutOfRange, "Vector::insert -- out of range");
+	}
+
+	const size_type positionIndex = static_cast<size_type>(std::distance(cbegin(), pos));
+
+	if (_size == _capacity)
+	{
+		emplace_reallocate(positionIndex, std::forward<U>(value)...);
+	}
+	else if (positionIndex == _size)
+	{
+		emplace_back_internal(std::forward<U>(value)...);
+	}
+	else if constexpr (std::is_nothrow_move_assignable_v<T>)
+	{
+		// Built up front since the arguments may refer to an element that is about to be shifted.
+		T element(std::forward<U>(value)...);
+
+		emplace_back_internal(std::move(*(end() - 1)));
+
+		std::move_backward(begin() + positionIndex, end() - 1, end());
+
+		_container[positionIndex] = std::move(element);
+	}
+	else
+	{
+		emplace_shift_by_copy(positionIndex, std::forward<U>(value)...);
+	}
+
+	_size += 1;
+
+	return begin() + positionIndex;
+}
+
+// Builds the grown container directly in a fresh buffer: the new element first,
+// then the elements before and after it, so every existing element is relocated
+// exactly once. The old buffer is only released once everything has been
+// constructed, so any exception leaves *this untouched.
+template<typename T, typename SizeType, typename Deleter>
+template<class... U>
+VECTOR_CONSTEXPR void Vector<T, SizeType, Deleter>::emplace_reallocate(const size_type positionIndex, U&& ... value)
+{
+	const size_type newCapacity = grown_capacity(_capacity);
+
+	T* newContainer = allocate_storage(newCapacity);
+	T* newElement = newContainer + positionIndex;
+
+	VECTOR_TRY
+	{
+		construct_element(newElement, std::forward<U>(value)...);
+	}
+	VECTOR_CATCH_ALL
+	{
+		deallocate_storage(newContainer, newCapacity);
+		VECTOR_RETHROW;
+	}
+
+	VECTOR_TRY
+	{
+		relocate(begin(), begin() + positionIndex, newContainer);
+	}
+	VECTOR_CATCH_ALL
+	{
+		newElement->~T();
+		deallocate_storage(newContainer, newCapacity);
+		VECTOR_RETHROW;
+	}
+
+	VECTOR_TRY
+	{
+		relocate(begin() + positionIndex, end(), newElement + 1);
+	}
+	VECTOR_CATCH_ALL
+	{
+		std::destroy(newContainer, newElement + 1);
+		deallocate_storage(newContainer, newCapacity);
+		VECTOR_RETHROW;
+	}
+
+	destroy_storage();
+
+	_container = newContainer;
+	_capacity = newCapacity;
+}
+
+// In-place insert for types whose move assignment may throw. The tail is shifted
+// one slot to the right with copies, so every original value survives somewhere
+// in [pos, end] until the new element is stored. If any step throws the shift is
+// copied back and the container is restored (strong guarantee); should that
+// rollback throw as well, the container is left valid but unspecified (basic guarantee).
+template<typename T, typename SizeType, typename Deleter>
+template<class... U>
+VECTOR_CONSTEXPR void Vector<T, SizeType, Deleter>::emplace_shift_by_copy(const size_type positionIndex, U&& ... value)
+{
+	T element(std::forward<U>(value)...);
+
+	construct_element(_container + _size, std::as_const(*(end() - 1)));
 
-	if (void* try_alloc_mem = _aligned_malloc(sizeof(T) * _capacity, alignof(T)))
+	size_type index = _size - 1;
+
+	VECTOR_TRY
 	{
-		try
+		for (; index > positionIndex; --index)
 		{
-			auto alloced_mem = static_cast<T*>(try_alloc_mem);
+			_container[index] = std::as_const(_container[index - 1]);
+		}
 
-			if constexpr (std::is_trivially_copyable_v<T>)
+		_container[positionIndex] = std::move(element);
+	}
+	VECTOR_CATCH_ALL
+	{
+		VECTOR_TRY
+		{
+			for (; index < _size; ++index)
 			{
-				memcopy_trivially(alloced_mem, _container, _size);
+				_container[index] = std::as_const(_container[index + 1]);
 			}
-			else
+		}
+		VECTOR_CATCH_ALL
+		{
+			(_container + _size)->~T();
+			VECTOR_RETHROW;
+		}
+
+		(_container + _size)->~T();
+		VECTOR_RETHROW;
+	}
+}
+
+// With a known length the range is copied in one step, straight into the new
+// buffer when one is needed. The range may point into this Vector, so it is
+// copied before the old elements are relocated and their buffer is released.
+// A range of unknown length grows the Vector as it goes. Either way a failure
+// destroys whatever was appended.
+template<typename T, typename SizeType, typename Deleter>
+template<typename InputIterator>
+VECTOR_CONSTEXPR void Vector<T, SizeType, Deleter>::append_range(InputIterator first, InputIterator last)
+{
+	if constexpr (std::is_base_of_v<std::forward_iterator_tag, iterator_category_t<InputIterator>>)
+	{
+		const size_type newSize = checked_size(static_cast<std::size_t>(_size) + static_cast<std::size_t>(std::distance(first, last)));
+
+		if (newSize <= _capacity)
+		{
+			copy_construct_range(first, last, end());
+			_size = newSize;
+
+			return;
+		}
+
+		const size_type newCapacity = std::max(newSize, grown_capacity(_capacity));
+		T* newContainer = allocate_storage(newCapacity);
+
+		VECTOR_TRY
+		{
+			copy_construct_range(first, last, newContainer + _size);
+		}
+		VECTOR_CATCH_ALL
+		{
+			deallocate_storage(newContainer, newCapacity);
+			VECTOR_RETHROW;
+		}
+
+		VECTOR_TRY
+		{
+			relocate(begin(), end(), newContainer);
+		}
+		VECTOR_CATCH_ALL
+		{
+			std::destroy(newContainer + _size, newContainer + newSize);
+			deallocate_storage(newContainer, newCapacity);
+			VECTOR_RETHROW;
+		}
+
+		destroy_storage();
+
+		_container = newContainer;
+		_size = newSize;
+		_capacity = newCapacity;
+	}
+	else
+	{
+		const size_type oldSize = _size;
+
+		VECTOR_TRY
+		{
+			for (; first != last; ++first)
 			{
-				uninitialized_move_or_copy<T>(begin(), end(), alloced_mem);
+				emplace_back(*first);
 			}
+		}
+		VECTOR_CATCH_ALL
+		{
+			std::destroy(begin() + oldSize, end());
+			_size = oldSize;
+			VECTOR_RETHROW;
+		}
+	}
+}
 
-			clear();
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR void Vector<T, SizeType, Deleter>::relocate(T* first, T* last, T* dest)
+{
+	constexpr bool moveElements = std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>;
 
-			_container = alloced_mem;
+	if (constant_evaluated())
+	{
+		for (; first != last; ++first, ++dest)
+		{
+			if constexpr (moveElements)
+			{
+				construct_element(dest, std::move(*first));
+			}
+			else
+			{
+				construct_element(dest, std::as_const(*first));
+			}
 		}
-		catch (...)
+	}
+	else if constexpr (std::is_trivially_copyable_v<T>)
+	{
+		if (first != last)
 		{
-			_aligned_free(try_alloc_mem);
-			throw;
+			std::memcpy(static_cast<void*>(dest), first, (last - first) * sizeof(T));
 		}
 	}
+	else if constexpr (moveElements)
+	{
+		std::uninitialized_move(first, last, dest);
+	}
 	else
 	{
-		throw std::bad_alloc();
+		std::uninitialized_copy(first, last, dest);
 	}
 }
 
-template<typename T>
-void Vector<T>::resize()
+template<typename T, typename SizeType, typename Deleter>
+constexpr bool Vector<T, SizeType, Deleter>::constant_evaluated() noexcept
 {
-	reallocate(std::max(static_cast<size_type>(2), _capacity * 2));
+#if VECTOR_HAS_CONSTEXPR_ALLOCATION
+	return std::is_constant_evaluated();
+#else
+	return false;
+#endif
 }
 
-template<typename T>
-inline void Vector<T>::swap(Vector<T>& other) noexcept
+template<typename T, typename SizeType, typename Deleter>
+template<int Policy>
+VECTOR_CONSTEXPR inline void Vector<T, SizeType, Deleter>::check_access(const bool valid, const VectorError error, const char* message) noexcept(Policy != VECTOR_ACCESS_CHECKED)
 {
-	std::swap(_size, other._size);
-	std::swap(_capacity, other._capacity);
-	std::swap(_container, other._container);
+	if constexpr (Policy == VECTOR_ACCESS_ASSERT)
+	{
+		assert(valid && "Vector -- invalid element access");
+	}
+	else if constexpr (Policy == VECTOR_ACCESS_CHECKED)
+	{
+		if (VECTOR_UNLIKELY(!valid))
+		{
+			VectorErrorPolicy::raise(error, message);
+		}
+	}
+
+	(void)valid;
+	(void)error;
+	(void)message;
 }
 
-template<typename T>
-void Vector<T>::memcopy_trivially(T* dest, T* src, const size_type size)
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR typename Vector<T, SizeType, Deleter>::size_type
+Vector<T, SizeType, Deleter>::checked_size(const std::size_t count)
 {
-	std::memcpy(dest, src, size * sizeof(T));
-	_size = size;
+	if (count > max_size())
+	{
+		VectorErrorPolicy::raise(VectorError::Length, "Vector -- size exceeds max_size()");
+	}
+
+	return static_cast<size_type>(count);
 }
 
-template<typename T>
-template<class... U>
-void Vector<T>::emplace_internal(iterator pos, U&& ... value)
+// Doubles the capacity, clamped to max_size() so that a narrow size_type never
+// wraps around; only a vector that is already at max_size() can't grow.
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR typename Vector<T, SizeType, Deleter>::size_type
+Vector<T, SizeType, Deleter>::grown_capacity(const size_type capacity)
 {
-	if (pos < begin() || pos > end())
+	if (capacity >= max_size())
+	{
+		VectorErrorPolicy::raise(VectorError::Length, "Vector -- size exceeds max_size()");
+	}
+
+	if (capacity > max_size() / 2)
+	{
+		return max_size();
+	}
+
+	return std::max(static_cast<size_type>(2), static_cast<size_type>(capacity * 2));
+}
+
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR T* Vector<T, SizeType, Deleter>::allocate_storage(const size_type capacity)
+{
+	if (capacity == 0)
+	{
+		return nullptr;
+	}
+
+	if (capacity > max_size())
+	{
+		VectorErrorPolicy::raise(VectorError::Length, "Vector -- size exceeds max_size()");
+	}
+
+	if (constant_evaluated())
 	{
-		throw std::out_of_range("Vector::insert -- out of range");
+		return std::allocator<T>().allocate(capacity);
 	}
 
-	if (pos == end())
+	if (VectorAllocationHooks::reuse)
 	{
-		if (_size == _capacity)
+		if (void* reused = VectorAllocationHooks::reuse(sizeof(T) * capacity, alignof(T)))
 		{
-			resize();
+			return static_cast<T*>(reused);
 		}
+	}
 
-		emplace_back_internal(value...);
+	if (void* memory = _aligned_malloc(sizeof(T) * capacity, alignof(T)))
+	{
+		if (VectorAllocationHooks::onAllocate)
+		{
+			VectorAllocationHooks::onAllocate(memory, sizeof(T) * capacity);
+		}
 
-		return;
+		return static_cast<T*>(memory);
 	}
 
-	const size_type positionIndex = std::distance(begin(), pos);
+	VectorErrorPolicy::raise(VectorError::BadAlloc, "Vector -- allocation failed");
+}
 
-	if (_size == _capacity)
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR void Vector<T, SizeType, Deleter>::deallocate_storage(T* container, const size_type capacity) noexcept
+{
+	if (constant_evaluated())
 	{
-		resize();
+		if (container)
+		{
+			std::allocator<T>().deallocate(container, capacity);
+		}
+
+		return;
 	}
 
-	emplace_back_internal(std::move(back()));
+	deallocate_buffer(container, capacity);
+}
+
+template<typename T, typename SizeType, typename Deleter>
+template<class... Args>
+VECTOR_CONSTEXPR inline void Vector<T, SizeType, Deleter>::construct_element(T* position, Args&& ... args)
+{
+#if VECTOR_HAS_CONSTEXPR_ALLOCATION
+	std::construct_at(position, std::forward<Args>(args)...);
+#else
+	new(position) T(std::forward<Args>(args)...);
+#endif
+}
+
+template<typename T, typename SizeType, typename Deleter>
+template<typename InputIterator>
+VECTOR_CONSTEXPR void Vector<T, SizeType, Deleter>::copy_construct_range(InputIterator first, InputIterator last, T* dest)
+{
+	constexpr bool copyBytes = std::is_trivially_copyable_v<T> && std::is_pointer_v<InputIterator>
+		&& std::is_same_v<std::remove_cv_t<std::remove_pointer_t<InputIterator>>, T>;
 
-	if constexpr (std::is_nothrow_move_assignable_v<T>)
+	if (constant_evaluated())
 	{
-		std::move_backward(begin() + positionIndex, end() - 1, end());
+		for (; first != last; ++first, ++dest)
+		{
+			construct_element(dest, *first);
+		}
 	}
-	else
+	else if constexpr (copyBytes)
 	{
-		Vector<T> tmp(*this);
-		try
+		if (first != last)
 		{
-			std::copy_backward(begin() + positionIndex, end() - 1, end()); // does mempcy for trivial objects
+			std::memcpy(static_cast<void*>(dest), first, (last - first) * sizeof(T));
 		}
-		catch (...)
+	}
+	else
+	{
+		std::uninitialized_copy(first, last, dest);
+	}
+}
+
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR void Vector<T, SizeType, Deleter>::value_construct_range(T* first, const size_type count)
+{
+	if (constant_evaluated())
+	{
+		for (size_type i = 0; i < count; ++i)
 		{
-			clear();
-			swap(tmp);
-			throw;
+			construct_element(first + i);
 		}
 	}
+	else
+	{
+		std::uninitialized_value_construct_n(first, count);
+	}
+}
 
-	new(begin() + positionIndex) T(std::forward<U>(value)...);
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR void Vector<T, SizeType, Deleter>::fill_construct_range(T* first, const size_type count, const T& value)
+{
+	if (constant_evaluated())
+	{
+		for (size_type i = 0; i < count; ++i)
+		{
+			construct_element(first + i, value);
+		}
+	}
+	else
+	{
+		std::uninitialized_fill_n(first, count, value);
+	}
 }
 
-template<typename T>
+template<typename T, typename SizeType, typename Deleter>
 template<class... Args>
-inline void Vector<T>::emplace_back_internal(Args&& ... element)
+VECTOR_CONSTEXPR inline void Vector<T, SizeType, Deleter>::emplace_back_internal(Args&& ... element)
 {
-	new(_container + _size) T(std::forward<Args>(element)...);
+	construct_element(_container + _size, std::forward<Args>(element)...);
 }
 
-template<typename T>
-inline bool operator==(const Vector<T>& a, const Vector<T>& b)
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR inline bool operator==(const Vector<T, SizeType, Deleter>& a, const Vector<T, SizeType, Deleter>& b)
 {
 	return ((a.size() == b.size()) && std::equal(a.begin(), a.end(), b.begin()));
 }
 
-template<typename T>
-typename Vector<T>::reference
-Vector<T>::operator[](const size_t index) noexcept
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR typename Vector<T, SizeType, Deleter>::reference
+Vector<T, SizeType, Deleter>::operator[](const std::size_t index) noexcept(VECTOR_INDEX_ACCESS_POLICY != VECTOR_ACCESS_CHECKED)
 {
+	check_access<VECTOR_INDEX_ACCESS_POLICY>(index < _size, VectorError::OutOfRange, "Vector::operator[] -- out of range");
+
 	return *(begin() + index);
 }
 
-template<typename T>
-typename Vector<T>::const_reference
-Vector<T>::operator[](const size_t index) const noexcept
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR typename Vector<T, SizeType, Deleter>::const_reference
+Vector<T, SizeType, Deleter>::operator[](const std::size_t index) const noexcept(VECTOR_INDEX_ACCESS_POLICY != VECTOR_ACCESS_CHECKED)
 {
+	check_access<VECTOR_INDEX_ACCESS_POLICY>(index < _size, VectorError::OutOfRange, "Vector::operator[] -- out of range");
+
 	return *(begin() + index);
 }
 
-template<typename T>
-typename Vector<T>::reference
-Vector<T>::at(const size_type index)
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR typename Vector<T, SizeType, Deleter>::reference
+Vector<T, SizeType, Deleter>::at(const std::size_t index)
 {
 	if (index >= size())
 	{
-		throw std::out_of_range("Vector::at -- out of range");
+		VectorErrorPolicy::raise(VectorError::OutOfRange, "Vector::at -- out of range");
 	}
 
 	return _container[index];
 }
 
-template<typename T>
-typename Vector<T>::const_reference
-Vector<T>::at(const size_type index) const
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR typename Vector<T, SizeType, Deleter>::const_reference
+Vector<T, SizeType, Deleter>::at(const std::size_t index) const
 {
 	if (index >= size())
 	{
-		throw std::out_of_range("Vector::at -- out of range");
+		VectorErrorPolicy::raise(VectorError::OutOfRange, "Vector::at -- out of range");
 	}
 
 	return _container[index];
 }
 
-template<typename T>
-inline bool Vector<T>::validate() const noexcept
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR inline bool Vector<T, SizeType, Deleter>::validate() const noexcept
 {
 	return (_capacity >= _size);
 }
 
-template<typename T>
-inline bool Vector<T>::empty() const noexcept
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR inline bool Vector<T, SizeType, Deleter>::empty() const noexcept
 {
 	return _size == 0;
 }
 
-template<typename T>
-inline typename Vector<T>::size_type
-Vector<T>::size() const noexcept
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR inline typename Vector<T, SizeType, Deleter>::size_type
+Vector<T, SizeType, Deleter>::size() const noexcept
 {
 	return _size;
 }
 
-template<typename T>
-inline typename Vector<T>::size_type
-Vector<T>::capacity() const noexcept
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR inline typename Vector<T, SizeType, Deleter>::size_type
+Vector<T, SizeType, Deleter>::capacity() const noexcept
 {
 	return _capacity;
 }
 
-template<typename T>
-inline void Vector<T>::reserve(const size_type newCapacity)
+template<typename T, typename SizeType, typename Deleter>
+constexpr typename Vector<T, SizeType, Deleter>::size_type
+Vector<T, SizeType, Deleter>::max_size() noexcept
+{
+	constexpr std::size_t maxElements = static_cast<std::size_t>(PTRDIFF_MAX) / sizeof(T);
+
+	return static_cast<size_type>(std::min<std::size_t>(std::numeric_limits<size_type>::max(), maxElements));
+}
+
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR inline void Vector<T, SizeType, Deleter>::reserve(const std::size_t desiredCapacity)
 {
-	if (newCapacity <= _capacity)
+	if (desiredCapacity <= _capacity)
 	{
 		return;
 	}
 
+	const size_type newCapacity = checked_size(desiredCapacity);
+
 	if (!empty())
 	{
 		reallocate(newCapacity);
 	}
 	else
 	{
-		_aligned_free(_container);
+		T* newContainer = allocate_storage(newCapacity);
+
+		deallocate_container();
 
-		_container = static_cast<T*>(_aligned_malloc(sizeof(T) * newCapacity, alignof(T)));
+		_container = newContainer;
 	}
 
 	_capacity = newCapacity;
 }
 
-template<typename T>
-inline typename Vector<T>::iterator
-Vector<T>::begin() noexcept
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR inline typename Vector<T, SizeType, Deleter>::iterator
+Vector<T, SizeType, Deleter>::begin() noexcept
 {
 	return _container;
 }
 
-template<typename T>
-inline typename Vector<T>::const_iterator
-Vector<T>::begin() const noexcept
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR inline typename Vector<T, SizeType, Deleter>::const_iterator
+Vector<T, SizeType, Deleter>::begin() const noexcept
 {
 	return _container;
 }
 
-template<typename T>
-typename Vector<T>::const_iterator
-Vector<T>::cbegin() const noexcept
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR typename Vector<T, SizeType, Deleter>::const_iterator
+Vector<T, SizeType, Deleter>::cbegin() const noexcept
 {
 	return _container;
 }
 
-template<typename T>
-inline typename Vector<T>::iterator
-Vector<T>::end() noexcept
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR inline typename Vector<T, SizeType, Deleter>::iterator
+Vector<T, SizeType, Deleter>::end() noexcept
 {
 	return _container + _size;
 }
 
-template<typename T>
-inline typename Vector<T>::const_iterator
-Vector<T>::end() const noexcept
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR inline typename Vector<T, SizeType, Deleter>::const_iterator
+Vector<T, SizeType, Deleter>::end() const noexcept
 {
 	return _container + _size;
 }
 
-template<typename T>
-typename Vector<T>::const_iterator
-Vector<T>::cend() const noexcept
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR typename Vector<T, SizeType, Deleter>::const_iterator
+Vector<T, SizeType, Deleter>::cend() const noexcept
 {
 	return _container + _size;
 }
 
-template<typename T>
-inline typename Vector<T>::reference
-Vector<T>::front()
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR inline typename Vector<T, SizeType, Deleter>::reference
+Vector<T, SizeType, Deleter>::front()
 {
 	return const_cast<reference>(std::as_const(*this).front());
 }
 
-template<typename T>
-inline typename Vector<T>::const_reference
-Vector<T>::front() const
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR inline typename Vector<T, SizeType, Deleter>::const_reference
+Vector<T, SizeType, Deleter>::front() const
 {
-	if (empty())
-	{
-		throw std::range_error("vector::front -- empty vector");
-	}
+	check_access<VECTOR_END_ACCESS_POLICY>(!empty(), VectorError::Range, "vector::front -- empty vector");
 
 	return *begin();
 }
 
-template<typename T>
-inline typename Vector<T>::reference
-Vector<T>::back()
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR inline typename Vector<T, SizeType, Deleter>::reference
+Vector<T, SizeType, Deleter>::back()
 {
 	return const_cast<reference>(std::as_const(*this).back());
 }
 
-template<typename T>
-inline typename Vector<T>::const_reference
-Vector<T>::back() const
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR inline typename Vector<T, SizeType, Deleter>::const_reference
+Vector<T, SizeType, Deleter>::back() const
 {
-	if (empty())
+	check_access<VECTOR_END_ACCESS_POLICY>(!empty(), VectorError::Range, "vector::back -- empty vector");
+
+	return *std::prev(end());
+}
+
+template<typename T, typename SizeType, typename Deleter>
+void Vector<T, SizeType, Deleter>::adopt(pointer container, const size_type size, const size_type capacity)
+{
+	if (size > capacity)
 	{
-		throw std::range_error("vector::back -- empty vector");
+		VectorErrorPolicy::raise(VectorError::Length, "Vector::adopt -- size exceeds capacity");
 	}
 
-	return *std::prev(end());
+	destroy_storage();
+
+	_container = container;
+	_size = size;
+	_capacity = capacity;
 }
 
-template<typename T>
-inline typename Vector<T>::const_pointer
-Vector<T>::data() const noexcept
+template<typename T, typename SizeType, typename Deleter>
+template<typename D, typename>
+void Vector<T, SizeType, Deleter>::adopt(pointer container, const size_type size, const size_type capacity, buffer_deleter deleter)
+{
+	adopt(container, size, capacity);
+
+	// There is nothing to free for a null buffer, and allocate_buffer's own
+	// buffers need no deleter.
+	if (container && deleter != &Vector<T, SizeType, Deleter>::deallocate_buffer)
+	{
+		this->store_deleter(deleter);
+	}
+}
+
+template<typename T, typename SizeType, typename Deleter>
+typename Vector<T, SizeType, Deleter>::buffer_type
+Vector<T, SizeType, Deleter>::release()
+{
+	buffer_type buffer{ _container, _size, _capacity, &Vector<T, SizeType, Deleter>::deallocate_buffer };
+
+	if (buffer_deleter deleter = this->stored_deleter())
+	{
+		buffer.deleter = deleter;
+	}
+
+	_container = nullptr;
+	_size = 0;
+	_capacity = 0;
+	this->store_deleter(nullptr);
+
+	return buffer;
+}
+
+template<typename T, typename SizeType, typename Deleter>
+typename Vector<T, SizeType, Deleter>::pointer
+Vector<T, SizeType, Deleter>::allocate_buffer(const size_type capacity)
+{
+	return allocate_storage(capacity);
+}
+
+template<typename T, typename SizeType, typename Deleter>
+void Vector<T, SizeType, Deleter>::deallocate_buffer(pointer container, const size_type capacity) noexcept
+{
+	if (container && VectorAllocationHooks::recycle && VectorAllocationHooks::recycle(container, sizeof(T) * capacity))
+	{
+		return;
+	}
+
+	if (container && VectorAllocationHooks::onDeallocate)
+	{
+		VectorAllocationHooks::onDeallocate(container, sizeof(T) * capacity);
+	}
+
+	if (container && VectorAllocationHooks::release && VectorAllocationHooks::release(container, sizeof(T) * capacity))
+	{
+		return;
+	}
+
+	_aligned_free(container);
+}
+
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR inline typename Vector<T, SizeType, Deleter>::const_pointer
+Vector<T, SizeType, Deleter>::data() const noexcept
 {
 	return _container;
 }
 
-template<typename T>
-inline typename Vector<T>::pointer
-Vector<T>::data() noexcept
+template<typename T, typename SizeType, typename Deleter>
+VECTOR_CONSTEXPR inline typename Vector<T, SizeType, Deleter>::pointer
+Vector<T, SizeType, Deleter>::data() noexcept
 {
 	return _container;
 }
+
+///////////////////////////////////////////////////////////////////////////////
+/// VectorDecayPolicy
+///
+/// Trims a Vector that is cleared and refilled every cycle, such as a
+/// per-frame scratch buffer, once its buffer has stayed mostly empty for a
+/// while. Call end_cycle() once per cycle, before the clear(). A cycle counts
+/// as idle when the size is below capacity / slack; after idleCycles idle
+/// cycles in a row the capacity is shrunk to the largest size seen during
+/// them, the high watermark. Any busier cycle starts the count again, so a
+/// buffer that is regularly filled is never trimmed.
+///
+class VectorDecayPolicy
+{
+public:
+	explicit VectorDecayPolicy(std::size_t idleCycles = 60, std::size_t slack = 4) noexcept
+		:
+		_idleCycles(std::max<std::size_t>(1, idleCycles)),
+		_slack(std::max<std::size_t>(1, slack)),
+		_idleCount(0),
+		_highWatermark(0)
+	{
+	}
+
+	/// Returns true if the Vector was trimmed.
+	template<typename T, typename SizeType, typename Deleter>
+	bool end_cycle(Vector<T, SizeType, Deleter>& vector)
+	{
+		if (vector.size() >= vector.capacity() / _slack)
+		{
+			_idleCount = 0;
+			_highWatermark = 0;
+
+			return false;
+		}
+
+		_idleCount += 1;
+		_highWatermark = std::max<std::size_t>(_highWatermark, vector.size());
+
+		if (_idleCount < _idleCycles)
+		{
+			return false;
+		}
+
+		vector.shrink_to(static_cast<SizeType>(_highWatermark));
+
+		_idleCount = 0;
+		_highWatermark = 0;
+
+		return true;
+	}
+
+	std::size_t high_watermark() const noexcept
+	{
+		return _highWatermark;
+	}
+
+private:
+	std::size_t _idleCycles;
+	std::size_t _slack;
+	std::size_t _idleCount;
+	std::size_t _highWatermark;
+};
+
+#if VECTOR_HAS_CONSTEXPR_ALLOCATION
+///////////////////////////////////////////////////////////////////////////////
+/// freeze_vector
+///
+/// Runs a constexpr generator that returns a Vector and copies the result into
+/// a std::array, so a table can be built with the Vector API at compile time
+/// and stored as a static constant:
+///
+///    constexpr auto kSquares = freeze_vector<[] {
+///        Vector<int> v;
+///        for (int i = 0; i < 16; ++i) v.push_back(i * i);
+///        return v;
+///    }>();
+///
+/// The generator runs twice, once for the size and once for the contents,
+/// since a Vector allocated during constant evaluation can't outlive it.
+///
+template<auto Generator>
+constexpr auto freeze_vector()
+{
+	using vector_type = decltype(Generator());
+
+	constexpr std::size_t frozenSize = Generator().size();
+
+	std::array<typename vector_type::value_type, frozenSize> frozen{};
+	const vector_type elements = Generator();
+
+	std::copy(elements.begin(), elements.end(), frozen.begin());
+
+	return frozen;
+}
+#endif
\ No newline at end of file
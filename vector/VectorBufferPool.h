@@ -0,0 +1,249 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include "Vector.h"
+
+///////////////////////////////////////////////////////////////////////////////
+/// VectorBufferPool
+///
+/// Opt-in, per-thread cache of freed Vector buffers. While enabled on a
+/// thread, buffers that Vectors release on that thread are kept in buckets by
+/// power-of-two byte size instead of going back to _aligned_free, and new
+/// allocations on the thread are served from them when a cached buffer has
+/// exactly the requested size and suitable alignment. A Vector only knows the
+/// capacity it asked for, so a larger buffer would be recycled, hooked and
+/// freed under the wrong size; exact matches still hit for the common case of
+/// temporaries that grow through the same sequence of capacities.
+///
+/// The pool plugs into Vector through VectorAllocationHooks::reuse and
+/// recycle when this header is included; threads that never enable() it only
+/// pay for the hook calls.
+///
+/// The cache is bounded by set_limits() (buffers per bucket and total bytes);
+/// buffers beyond the limits are freed as usual. trim() frees cached buffers
+/// on demand, and whatever is left is freed when the thread exits. Buffers
+/// may be freed on a different thread than the one that allocated them.
+/// VectorAllocationHooks::onAllocate and onDeallocate see only the buffers
+/// that really reach the system allocator.
+///
+class VectorBufferPool
+{
+public:
+	static constexpr std::size_t kMaxBuffersPerBucket = 8;
+
+	struct statistics
+	{
+		std::size_t hits;          // allocations served from the cache
+		std::size_t misses;        // allocations the cache couldn't serve
+		std::size_t recycled;      // freed buffers kept in the cache
+		std::size_t dropped;       // freed buffers released because a limit was reached
+		std::size_t cachedBuffers;
+		std::size_t cachedBytes;
+	};
+
+	static void enable(bool enabled = true) noexcept
+	{
+		if (enabled)
+		{
+			static thread_local thread_exit emptyOnExit;
+			static_cast<void>(emptyOnExit);
+		}
+
+		state().enabled = enabled;
+	}
+
+	static bool enabled() noexcept
+	{
+		return state().enabled;
+	}
+
+	static void set_limits(std::size_t maxBuffersPerBucket, std::size_t maxCachedBytes) noexcept
+	{
+		state_type& pool = state();
+
+		pool.maxBuffersPerBucket = std::min(maxBuffersPerBucket, kMaxBuffersPerBucket);
+		pool.maxCachedBytes = maxCachedBytes;
+		trim(maxCachedBytes);
+	}
+
+	/// Frees cached buffers, largest first, until at most maxCachedBytes remain.
+	static void trim(std::size_t maxCachedBytes = 0) noexcept
+	{
+		trim(state(), maxCachedBytes);
+	}
+
+	static statistics stats() noexcept
+	{
+		return state().stats;
+	}
+
+	static void reset_stats() noexcept
+	{
+		statistics& stats = state().stats;
+
+		stats.hits = 0;
+		stats.misses = 0;
+		stats.recycled = 0;
+		stats.dropped = 0;
+	}
+
+	/// Returns a cached buffer of exactly bytes bytes, or nullptr.
+	static void* acquire(std::size_t bytes, std::size_t alignment) noexcept
+	{
+		state_type& pool = state();
+
+		if (!pool.enabled)
+		{
+			return nullptr;
+		}
+
+		const std::size_t bucket = bucket_index(bytes);
+
+		for (std::size_t i = pool.counts[bucket]; i-- > 0;)
+		{
+			entry& cached = pool.buckets[bucket][i];
+
+			if (cached.bytes == bytes && reinterpret_cast<std::uintptr_t>(cached.buffer) % alignment == 0)
+			{
+				void* buffer = cached.buffer;
+
+				pool.stats.cachedBuffers -= 1;
+				pool.stats.cachedBytes -= cached.bytes;
+				pool.stats.hits += 1;
+				cached = pool.buckets[bucket][--pool.counts[bucket]];
+
+				return buffer;
+			}
+		}
+
+		pool.stats.misses += 1;
+
+		return nullptr;
+	}
+
+	/// Keeps a freed buffer of the given size; returns false if the caller has
+	/// to free it because the pool is disabled or full.
+	static bool recycle(void* buffer, std::size_t bytes) noexcept
+	{
+		state_type& pool = state();
+
+		if (!pool.enabled)
+		{
+			return false;
+		}
+
+		const std::size_t bucket = bucket_index(bytes);
+
+		if (pool.counts[bucket] >= pool.maxBuffersPerBucket || pool.stats.cachedBytes + bytes > pool.maxCachedBytes)
+		{
+			pool.stats.dropped += 1;
+
+			return false;
+		}
+
+		pool.buckets[bucket][pool.counts[bucket]++] = entry{ buffer, bytes };
+		pool.stats.cachedBuffers += 1;
+		pool.stats.cachedBytes += bytes;
+		pool.stats.recycled += 1;
+
+		return true;
+	}
+
+private:
+	static constexpr std::size_t kBucketCount = sizeof(std::size_t) * 8;
+
+	struct entry
+	{
+		void* buffer;
+		std::size_t bytes;
+	};
+
+	// Trivially destructible and constant initialized, so that the state is
+	// valid for the whole life of the thread: Vectors in thread_local or static
+	// storage may release buffers after every thread_local destructor ran.
+	struct state_type
+	{
+		bool enabled = false;
+		std::size_t maxBuffersPerBucket = kMaxBuffersPerBucket;
+		std::size_t maxCachedBytes = std::size_t(16) << 20;
+		statistics stats = {};
+		std::array<std::size_t, kBucketCount> counts = {};
+		std::array<std::array<entry, kMaxBuffersPerBucket>, kBucketCount> buckets = {};
+	};
+
+	static_assert(std::is_trivially_destructible_v<state_type>, "VectorBufferPool state must outlive every Vector on its thread");
+
+	// Created on a thread the first time the pool is enabled there; when the
+	// thread exits it disables the pool, so that later releases are freed as
+	// usual, and frees what is cached.
+	struct thread_exit
+	{
+		~thread_exit()
+		{
+			state_type& pool = state();
+
+			pool.enabled = false;
+			trim(pool, 0);
+		}
+	};
+
+	static state_type& state() noexcept
+	{
+		static thread_local state_type pool;
+		return pool;
+	}
+
+	static void trim(state_type& pool, std::size_t maxCachedBytes) noexcept
+	{
+		for (std::size_t bucket = kBucketCount; bucket-- > 0 && pool.stats.cachedBytes > maxCachedBytes;)
+		{
+			while (pool.counts[bucket] > 0 && pool.stats.cachedBytes > maxCachedBytes)
+			{
+				const entry& cached = pool.buckets[bucket][--pool.counts[bucket]];
+
+				pool.stats.cachedBuffers -= 1;
+				pool.stats.cachedBytes -= cached.bytes;
+				free_buffer(cached.buffer, cached.bytes);
+			}
+		}
+	}
+
+	// floor(log2(bytes)): bucket k holds buffers of [2^k, 2^(k+1)) bytes.
+	static std::size_t bucket_index(std::size_t bytes) noexcept
+	{
+		std::size_t bucket = 0;
+
+		while (bytes >>= 1)
+		{
+			bucket += 1;
+		}
+
+		return bucket;
+	}
+
+	static void free_buffer(void* buffer, std::size_t bytes) noexcept
+	{
+		if (VectorAllocationHooks::onDeallocate)
+		{
+			VectorAllocationHooks::onDeallocate(buffer, bytes);
+		}
+
+		_aligned_free(buffer);
+	}
+};
+
+// Plugs the pool into every Vector of the program during static
+// initialization, before any thread can enable it.
+inline bool vector_buffer_pool_install() noexcept
+{
+	VectorAllocationHooks::reuse = &VectorBufferPool::acquire;
+	VectorAllocationHooks::recycle = &VectorBufferPool::recycle;
+
+	return true;
+}
+
+inline const bool kVectorBufferPoolInstalled = vector_buffer_pool_install();
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+
+// Errors are reported through VectorErrorPolicy::raise, and VECTOR_ERROR_POLICY
+// picks at compile time what that does:
+//
+//   VECTOR_ERROR_THROW    throw the matching standard exception; the default
+//                         when exceptions are enabled.
+//   VECTOR_ERROR_ABORT    print the message to stderr and abort; the default
+//                         when they are not.
+//   VECTOR_ERROR_HANDLER  call VectorErrorPolicy::onError, then abort.
+//
+// Without exceptions VECTOR_TRY and VECTOR_CATCH_ALL turn the rollback paths
+// into dead branches, so the header contains no try, catch or throw at all.
+#define VECTOR_ERROR_THROW 0
+#define VECTOR_ERROR_ABORT 1
+#define VECTOR_ERROR_HANDLER 2
+
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+#define VECTOR_EXCEPTIONS 1
+#else
+#define VECTOR_EXCEPTIONS 0
+#endif
+
+#ifndef VECTOR_ERROR_POLICY
+#if VECTOR_EXCEPTIONS
+#define VECTOR_ERROR_POLICY VECTOR_ERROR_THROW
+#else
+#define VECTOR_ERROR_POLICY VECTOR_ERROR_ABORT
+#endif
+#endif
+
+#if VECTOR_ERROR_POLICY == VECTOR_ERROR_THROW && !VECTOR_EXCEPTIONS
+#error "VECTOR_ERROR_THROW needs exceptions; use VECTOR_ERROR_ABORT or VECTOR_ERROR_HANDLER"
+#endif
+
+#if VECTOR_EXCEPTIONS
+#define VECTOR_TRY try
+#define VECTOR_CATCH_ALL catch (...)
+#define VECTOR_RETHROW throw
+#else
+#define VECTOR_TRY if (true)
+#define VECTOR_CATCH_ALL else
+#define VECTOR_RETHROW static_cast<void>(0)
+#endif
+
+enum class VectorError
+{
+	OutOfRange,     // std::out_of_range
+	Range,          // std::range_error
+	Length,         // std::length_error
+	BadAlloc        // std::bad_alloc
+};
+
+///////////////////////////////////////////////////////////////////////////////
+/// VectorErrorPolicy
+///
+/// Where every error in the containers ends up; see VECTOR_ERROR_POLICY. The
+/// onError handler of VECTOR_ERROR_HANDLER builds must not return, typically
+/// it logs and terminates or longjmps to a recovery point; should it return
+/// anyway the process is aborted.
+///
+class VectorErrorPolicy
+{
+public:
+	typedef void (*handler)(VectorError error, const char* message);
+
+	static inline handler onError = nullptr;
+
+	[[noreturn]] static void raise(VectorError error, const char* message)
+	{
+#if VECTOR_ERROR_POLICY == VECTOR_ERROR_THROW
+		switch (error)
+		{
+		case VectorError::OutOfRange:
+			throw std::out_of_range(message);
+		case VectorError::Range:
+			throw std::range_error(message);
+		case VectorError::Length:
+			throw std::length_error(message);
+		default:
+			throw std::bad_alloc();
+		}
+#else
+		static_cast<void>(error);
+
+#if VECTOR_ERROR_POLICY == VECTOR_ERROR_HANDLER
+		if (onError)
+		{
+			onError(error, message);
+		}
+#endif
+		std::fprintf(stderr, "%s\n", message);
+		std::abort();
+#endif
+	}
+};
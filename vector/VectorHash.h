@@ -0,0 +1,292 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include "Vector.h"
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+/// VectorHash
+///
+/// The hashing behind std::hash<Vector>. Elements whose object representation
+/// is unique (integers, enums, pointers and structs of them without padding)
+/// are hashed as one block of bytes with a wyhash-style function: 48-byte
+/// strides feed three independent 64x64->128 bit multiply lanes, so long keys
+/// hash at several bytes per cycle without depending on a particular SIMD
+/// instruction set. Other elements (floats, strings, padded structs) are
+/// hashed one by one with std::hash and the results are mixed in order.
+///
+/// Hashes are the same within a process run but are not meant to be stored.
+///
+class VectorHash
+{
+public:
+	static std::uint64_t hash_bytes(const void* data, std::size_t length, std::uint64_t seed = 0) noexcept
+	{
+		const std::uint8_t* bytes = static_cast<const std::uint8_t*>(data);
+		std::uint64_t a = 0;
+		std::uint64_t b = 0;
+
+		seed ^= mix(seed ^ kSecret[0], kSecret[1]);
+
+		if (length <= 16)
+		{
+			if (length >= 4)
+			{
+				const std::size_t middle = (length >> 3) << 2;
+
+				a = (read32(bytes) << 32) | read32(bytes + middle);
+				b = (read32(bytes + length - 4) << 32) | read32(bytes + length - 4 - middle);
+			}
+			else if (length > 0)
+			{
+				a = (std::uint64_t(bytes[0]) << 16) | (std::uint64_t(bytes[length >> 1]) << 8) | bytes[length - 1];
+			}
+		}
+		else
+		{
+			std::size_t remaining = length;
+
+			if (remaining > 48)
+			{
+				std::uint64_t lane1 = seed;
+				std::uint64_t lane2 = seed;
+
+				do
+				{
+					seed = mix(read64(bytes) ^ kSecret[1], read64(bytes + 8) ^ seed);
+					lane1 = mix(read64(bytes + 16) ^ kSecret[2], read64(bytes + 24) ^ lane1);
+					lane2 = mix(read64(bytes + 32) ^ kSecret[3], read64(bytes + 40) ^ lane2);
+					bytes += 48;
+					remaining -= 48;
+				}
+				while (remaining > 48);
+
+				seed ^= lane1 ^ lane2;
+			}
+
+			while (remaining > 16)
+			{
+				seed = mix(read64(bytes) ^ kSecret[1], read64(bytes + 8) ^ seed);
+				bytes += 16;
+				remaining -= 16;
+			}
+
+			a = read64(bytes + remaining - 16);
+			b = read64(bytes + remaining - 8);
+		}
+
+		a ^= kSecret[1];
+		b ^= seed;
+		multiply(a, b);
+
+		return mix(a ^ kSecret[0] ^ length, b ^ kSecret[1]);
+	}
+
+	/// Mixes the hash of the next element into a running hash.
+	static std::uint64_t combine(std::uint64_t hash, std::uint64_t elementHash) noexcept
+	{
+		return mix(hash ^ elementHash, kSecret[2]);
+	}
+
+	template<typename T, typename SizeType>
+	static std::uint64_t hash(const Vector<T, SizeType>& vector) noexcept
+	{
+		if constexpr (std::has_unique_object_representations_v<T>)
+		{
+			return hash_bytes(vector.data(), vector.size() * sizeof(T));
+		}
+		else
+		{
+			std::uint64_t result = mix(vector.size() ^ kSecret[0], kSecret[1]);
+
+			for (const T& element : vector)
+			{
+				result = combine(result, static_cast<std::uint64_t>(std::hash<T>()(element)));
+			}
+
+			return result;
+		}
+	}
+
+private:
+	static constexpr std::uint64_t kSecret[4] =
+	{
+		0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull, 0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull
+	};
+
+	// Replaces a and b by the low and high halves of their 128-bit product.
+	static void multiply(std::uint64_t& a, std::uint64_t& b) noexcept
+	{
+#if defined(__SIZEOF_INT128__)
+		const unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+		a = static_cast<std::uint64_t>(product);
+		b = static_cast<std::uint64_t>(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+		a = _umul128(a, b, &b);
+#else
+		const std::uint64_t aHigh = a >> 32, aLow = static_cast<std::uint32_t>(a);
+		const std::uint64_t bHigh = b >> 32, bLow = static_cast<std::uint32_t>(b);
+		const std::uint64_t high = aHigh * bHigh, middle0 = aHigh * bLow, middle1 = aLow * bHigh, low = aLow * bLow;
+		const std::uint64_t carry = ((low >> 32) + static_cast<std::uint32_t>(middle0) + static_cast<std::uint32_t>(middle1)) >> 32;
+
+		a = low + (middle0 << 32) + (middle1 << 32);
+		b = high + (middle0 >> 32) + (middle1 >> 32) + carry;
+#endif
+	}
+
+	static std::uint64_t mix(std::uint64_t a, std::uint64_t b) noexcept
+	{
+		multiply(a, b);
+
+		return a ^ b;
+	}
+
+	static std::uint64_t read64(const std::uint8_t* bytes) noexcept
+	{
+		std::uint64_t value;
+		std::memcpy(&value, bytes, sizeof(value));
+		return value;
+	}
+
+	static std::uint64_t read32(const std::uint8_t* bytes) noexcept
+	{
+		std::uint32_t value;
+		std::memcpy(&value, bytes, sizeof(value));
+		return value;
+	}
+};
+
+///////////////////////////////////////////////////////////////////////////////
+/// HashedVector
+///
+/// An immutable Vector that hashes its contents once, on construction, for
+/// large keys that are looked up many times. std::hash returns the stored
+/// hash, and comparisons check it before the elements.
+///
+template<typename T, typename SizeType = std::size_t>
+class HashedVector
+{
+public:
+	typedef                    Vector<T, SizeType> vector_type;
+	typedef typename           vector_type::size_type size_type;
+	typedef typename           vector_type::const_iterator const_iterator;
+
+public:
+	explicit HashedVector(vector_type vector);
+
+public:
+	const vector_type& vector() const noexcept;
+	std::uint64_t hash() const noexcept;
+
+	const T& operator[](const size_type n) const;
+	bool empty() const noexcept;
+	size_type size() const noexcept;
+	const T* data() const noexcept;
+	const_iterator begin() const noexcept;
+	const_iterator end() const noexcept;
+
+private:
+	vector_type _vector;
+	std::uint64_t _hash;
+};
+
+template<typename T, typename SizeType>
+HashedVector<T, SizeType>::HashedVector(vector_type vector)
+	:
+	_vector(std::move(vector)),
+	_hash(VectorHash::hash(_vector))
+{
+}
+
+template<typename T, typename SizeType>
+inline const typename HashedVector<T, SizeType>::vector_type&
+HashedVector<T, SizeType>::vector() const noexcept
+{
+	return _vector;
+}
+
+template<typename T, typename SizeType>
+inline std::uint64_t HashedVector<T, SizeType>::hash() const noexcept
+{
+	return _hash;
+}
+
+template<typename T, typename SizeType>
+inline const T& HashedVector<T, SizeType>::operator[](const size_type n) const
+{
+	return _vector[n];
+}
+
+template<typename T, typename SizeType>
+inline bool HashedVector<T, SizeType>::empty() const noexcept
+{
+	return _vector.empty();
+}
+
+template<typename T, typename SizeType>
+inline typename HashedVector<T, SizeType>::size_type
+HashedVector<T, SizeType>::size() const noexcept
+{
+	return _vector.size();
+}
+
+template<typename T, typename SizeType>
+inline const T* HashedVector<T, SizeType>::data() const noexcept
+{
+	return _vector.data();
+}
+
+template<typename T, typename SizeType>
+inline typename HashedVector<T, SizeType>::const_iterator
+HashedVector<T, SizeType>::begin() const noexcept
+{
+	return _vector.begin();
+}
+
+template<typename T, typename SizeType>
+inline typename HashedVector<T, SizeType>::const_iterator
+HashedVector<T, SizeType>::end() const noexcept
+{
+	return _vector.end();
+}
+
+template<typename T, typename SizeType>
+inline bool operator==(const HashedVector<T, SizeType>& a, const HashedVector<T, SizeType>& b)
+{
+	return a.hash() == b.hash() && a.vector() == b.vector();
+}
+
+template<typename T, typename SizeType>
+inline bool operator!=(const HashedVector<T, SizeType>& a, const HashedVector<T, SizeType>& b)
+{
+	return !(a == b);
+}
+
+namespace std
+{
+	template<typename T, typename SizeType>
+	struct hash<Vector<T, SizeType>>
+	{
+		std::size_t operator()(const Vector<T, SizeType>& vector) const noexcept
+		{
+			return static_cast<std::size_t>(VectorHash::hash(vector));
+		}
+	};
+
+	template<typename T, typename SizeType>
+	struct hash<HashedVector<T, SizeType>>
+	{
+		std::size_t operator()(const HashedVector<T, SizeType>& vector) const noexcept
+		{
+			return static_cast<std::size_t>(vector.hash());
+		}
+	};
+}
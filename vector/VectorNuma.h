@@ -0,0 +1,576 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include "Vector.h"
+
+// NUMA placement talks to the kernel directly (set_mempolicy, move_pages and
+// sched_setaffinity) so that nothing beyond libc is needed. Define
+// VECTOR_USE_LIBNUMA and link with -lnuma to go through libnuma instead.
+// Other platforms build the same API as a single-node fallback.
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#if defined(VECTOR_USE_LIBNUMA) && __has_include(<numa.h>)
+#include <numa.h>
+#include <numaif.h>
+#define VECTOR_NUMA_LIBNUMA 1
+#else
+#define VECTOR_NUMA_LIBNUMA 0
+#endif
+#define VECTOR_NUMA_LINUX 1
+#else
+#define VECTOR_NUMA_LINUX 0
+#define VECTOR_NUMA_LIBNUMA 0
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+/// NumaPlacement
+///
+/// Where the pages of a buffer end up.
+///
+/// Local             - wherever the calling thread runs; the plain Vector
+///                     behaviour.
+/// FirstTouchPerNode - the buffer is split into one contiguous, page aligned
+///                     slice per node, and each slice is first touched by a
+///                     thread pinned to that node. Suits workers that are
+///                     statically partitioned over the elements.
+/// Interleave        - pages alternate between nodes (MPOL_INTERLEAVE), for
+///                     data every node reads at random.
+///
+/// Placed buffers start on a page and span whole pages, so that placing them
+/// never moves another allocation's memory, and they bypass any buffer cache
+/// hooked into VectorAllocationHooks, whose buffers' pages are placed already.
+///
+enum class NumaPlacement
+{
+	Local,
+	FirstTouchPerNode,
+	Interleave
+};
+
+///////////////////////////////////////////////////////////////////////////////
+/// VectorNuma
+///
+/// Node discovery, page placement and page location queries behind the
+/// numa_* Vector helpers below.
+///
+class VectorNuma
+{
+public:
+	/// Ids of the online memory nodes; a single node 0 when NUMA isn't available.
+	static const Vector<int>& nodes()
+	{
+		static const Vector<int> onlineNodes = discover_nodes();
+		return onlineNodes;
+	}
+
+	static std::size_t node_count()
+	{
+		return nodes().size();
+	}
+
+	static std::size_t page_size()
+	{
+#if VECTOR_NUMA_LINUX
+		static const std::size_t pageSize = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+		return pageSize;
+#else
+		return 4096;
+#endif
+	}
+
+	/// Pins the calling thread to the CPUs of the given node. Returns false when
+	/// that isn't possible, in which case the thread keeps running anywhere.
+	static bool run_on_node(int node)
+	{
+#if VECTOR_NUMA_LIBNUMA
+		return numa_available() >= 0 && numa_run_on_node(node) == 0;
+#elif VECTOR_NUMA_LINUX
+		cpu_set_t cpus;
+		CPU_ZERO(&cpus);
+
+		char path[64];
+		std::snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+
+		for (int cpu : read_list(path))
+		{
+			if (cpu < CPU_SETSIZE)
+			{
+				CPU_SET(cpu, &cpus);
+			}
+		}
+
+		return CPU_COUNT(&cpus) > 0 && sched_setaffinity(0, sizeof(cpus), &cpus) == 0;
+#else
+		(void)node;
+		return false;
+#endif
+	}
+
+	/// Allocates a buffer for capacity elements that starts on a page and spans
+	/// whole pages, straight from _aligned_malloc. Free it with
+	/// Vector::deallocate_buffer; VectorAllocationHooks see it as a buffer of
+	/// sizeof(T) * capacity bytes.
+	template<typename T, typename SizeType>
+	static T* allocate_pages(const SizeType capacity)
+	{
+		if (capacity == 0)
+		{
+			return nullptr;
+		}
+
+		if (capacity > Vector<T, SizeType>::max_size())
+		{
+			VectorErrorPolicy::raise(VectorError::Length, "VectorNuma -- size exceeds max_size()");
+		}
+
+		const std::size_t page = page_size();
+		const std::size_t bytes = sizeof(T) * capacity;
+		void* memory = nullptr;
+
+		if (bytes <= std::numeric_limits<std::size_t>::max() - page)
+		{
+			memory = _aligned_malloc((bytes + page - 1) / page * page, std::max(page, alignof(T)));
+		}
+
+		if (!memory)
+		{
+			VectorErrorPolicy::raise(VectorError::BadAlloc, "VectorNuma -- allocation failed");
+		}
+
+		if (VectorAllocationHooks::onAllocate)
+		{
+			VectorAllocationHooks::onAllocate(memory, bytes);
+		}
+
+		return static_cast<T*>(memory);
+	}
+
+	/// Faults in the pages of [data, data + bytes) from the calling thread
+	/// under an interleave policy, so that they alternate between all nodes,
+	/// then restores the thread's policy. Unlike mbind this leaves no policy on
+	/// the memory, which would outlive the buffer. The range must be raw
+	/// storage from allocate_pages, since one byte of every page is
+	/// overwritten; pages that are already populated stay where they are.
+	static bool interleave(void* data, std::size_t bytes)
+	{
+#if VECTOR_NUMA_LINUX
+		if (bytes == 0 || node_count() < 2)
+		{
+			return false;
+		}
+
+		constexpr std::size_t kBitsPerWord = sizeof(unsigned long) * 8;
+		unsigned long mask[16] = {};
+		int maxNode = 0;
+
+		for (int node : nodes())
+		{
+			if (static_cast<std::size_t>(node) < sizeof(mask) * 8)
+			{
+				mask[node / kBitsPerWord] |= 1UL << (node % kBitsPerWord);
+				maxNode = std::max(maxNode, node);
+			}
+		}
+
+		int previousMode = 0;
+		unsigned long previousMask[16] = {};
+
+		if (syscall(SYS_get_mempolicy, &previousMode, previousMask, sizeof(previousMask) * 8, nullptr, 0) != 0)
+		{
+			return false;
+		}
+
+		// MPOL_INTERLEAVE is 3; the kernel reads maxnode - 1 bits of the mask.
+		if (syscall(SYS_set_mempolicy, 3, mask, maxNode + 2) != 0)
+		{
+			return false;
+		}
+
+		touch_pages(data, bytes);
+		syscall(SYS_set_mempolicy, previousMode, previousMask, sizeof(previousMask) * 8);
+
+		return true;
+#else
+		(void)data;
+		(void)bytes;
+		return false;
+#endif
+	}
+
+	/// Node of every page spanned by [data, data + bytes), in address order.
+	/// Entries are negative errno values for pages the kernel couldn't report,
+	/// e.g. -ENOENT for pages that were never touched.
+	static Vector<int> page_nodes(const void* data, std::size_t bytes)
+	{
+		Vector<int> result;
+
+		if (bytes == 0)
+		{
+			return result;
+		}
+
+		const std::size_t page = page_size();
+		const std::uintptr_t first = reinterpret_cast<std::uintptr_t>(data) & ~(page - 1);
+		const std::uintptr_t last = reinterpret_cast<std::uintptr_t>(data) + bytes;
+		const std::size_t pageCount = (last - first + page - 1) / page;
+
+		result.reserve(pageCount);
+
+#if VECTOR_NUMA_LINUX
+		Vector<void*> pages;
+		pages.reserve(pageCount);
+
+		for (std::size_t i = 0; i < pageCount; ++i)
+		{
+			pages.push_back(reinterpret_cast<void*>(first + i * page));
+			result.push_back(0);
+		}
+
+		if (syscall(SYS_move_pages, 0, pageCount, pages.data(), nullptr, result.data(), 0) != 0)
+		{
+			const int error = errno;
+			std::fill(result.begin(), result.end(), -error);
+		}
+#else
+		for (std::size_t i = 0; i < pageCount; ++i)
+		{
+			result.push_back(0);
+		}
+#endif
+
+		return result;
+	}
+
+	/// Runs task(nodeIndex, node) on one thread per node, pinned to that node,
+	/// and rethrows the first exception once every thread has finished.
+	template<typename Task>
+	static void run_per_node(Task&& task)
+	{
+		const Vector<int>& online = nodes();
+
+		if (online.size() < 2)
+		{
+			task(std::size_t(0), online[0]);
+			return;
+		}
+
+		Vector<std::exception_ptr> errors(online.size());
+		Vector<std::thread> threads;
+		threads.reserve(online.size());
+
+		for (std::size_t i = 0; i < online.size(); ++i)
+		{
+			threads.emplace_back([&task, &errors, &online, i]()
+			{
+				VECTOR_TRY
+				{
+					run_on_node(online[i]);
+					task(i, online[i]);
+				}
+				VECTOR_CATCH_ALL
+				{
+					errors[i] = std::current_exception();
+				}
+			});
+		}
+
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+
+		for (const std::exception_ptr& error : errors)
+		{
+			if (error)
+			{
+				std::rethrow_exception(error);
+			}
+		}
+	}
+
+	/// Faults in the pages of [data, data + bytes) slice by slice, each from a
+	/// thread pinned to the slice's node (see node_slice). Same requirements
+	/// as interleave().
+	static void first_touch_per_node(void* data, std::size_t bytes)
+	{
+		if (bytes == 0 || node_count() < 2)
+		{
+			return;
+		}
+
+		run_per_node([data, bytes](std::size_t nodeIndex, int)
+		{
+			const auto slice = node_slice(nodeIndex, node_count(), bytes, 1);
+			touch_pages(static_cast<unsigned char*>(data) + slice.first, slice.second - slice.first);
+		});
+	}
+
+	/// Splits count elements of elementSize bytes, stored from the start of a
+	/// page, over nodeCount nodes: the bytes are cut into runs of whole pages,
+	/// one per node, and each node gets the elements that start in its run.
+	static std::pair<std::size_t, std::size_t> node_slice(std::size_t nodeIndex, std::size_t nodeCount, std::size_t count, std::size_t elementSize)
+	{
+		const std::size_t page = page_size();
+		const std::size_t bytes = count * elementSize;
+		const std::size_t pages = (bytes + page - 1) / page;
+		const std::size_t bytesPerNode = (pages + nodeCount - 1) / nodeCount * page;
+
+		const std::size_t firstByte = std::min(bytes, nodeIndex * bytesPerNode);
+		const std::size_t lastByte = std::min(bytes, firstByte + bytesPerNode);
+
+		return { (firstByte + elementSize - 1) / elementSize, (lastByte + elementSize - 1) / elementSize };
+	}
+
+private:
+	static void touch_pages(void* data, std::size_t bytes) noexcept
+	{
+		volatile unsigned char* first = static_cast<unsigned char*>(data);
+
+		for (std::size_t offset = 0; offset < bytes; offset += page_size())
+		{
+			first[offset] = 0;
+		}
+	}
+
+	static Vector<int> discover_nodes()
+	{
+		Vector<int> online;
+
+#if VECTOR_NUMA_LIBNUMA
+		if (numa_available() >= 0)
+		{
+			for (int node = 0; node <= numa_max_node(); ++node)
+			{
+				if (numa_bitmask_isbitset(numa_all_nodes_ptr, node))
+				{
+					online.push_back(node);
+				}
+			}
+		}
+#elif VECTOR_NUMA_LINUX
+		online = read_list("/sys/devices/system/node/online");
+#endif
+
+		if (online.empty())
+		{
+			online.push_back(0);
+		}
+
+		return online;
+	}
+
+#if VECTOR_NUMA_LINUX
+	// Parses the kernel's list format, e.g. "0-3,8,10-11".
+	static Vector<int> read_list(const char* path)
+	{
+		Vector<int> values;
+		std::FILE* file = std::fopen(path, "r");
+
+		if (!file)
+		{
+			return values;
+		}
+
+		int first = 0;
+		while (std::fscanf(file, "%d", &first) == 1)
+		{
+			int last = first;
+			int separator = std::fgetc(file);
+
+			if (separator == '-')
+			{
+				if (std::fscanf(file, "%d", &last) != 1)
+				{
+					break;
+				}
+
+				separator = std::fgetc(file);
+			}
+
+			for (int value = first; value <= last; ++value)
+			{
+				values.push_back(value);
+			}
+
+			if (separator != ',')
+			{
+				break;
+			}
+		}
+
+		std::fclose(file);
+
+		return values;
+	}
+#endif
+};
+
+///////////////////////////////////////////////////////////////////////////////
+/// numa_generate_vector
+///
+/// Builds a Vector of count elements, element i constructed from
+/// generator(i), with its pages placed as requested. With FirstTouchPerNode
+/// and Interleave the pages are placed first, then every node constructs its
+/// own slice on a pinned thread, so the generator must be safe to call
+/// concurrently. If any construction
+/// throws, everything built so far is destroyed and the exception rethrown.
+///
+template<typename T, typename SizeType = std::size_t, typename Generator>
+Vector<T, SizeType> numa_generate_vector(const SizeType count, NumaPlacement placement, Generator generator)
+{
+	typedef Vector<T, SizeType> vector_type;
+
+	T* container = VectorNuma::allocate_pages<T>(count);
+
+	if (placement == NumaPlacement::Interleave)
+	{
+		VectorNuma::interleave(container, sizeof(T) * count);
+	}
+	else if (placement == NumaPlacement::FirstTouchPerNode)
+	{
+		VectorNuma::first_touch_per_node(container, sizeof(T) * count);
+	}
+
+	const std::size_t sliceCount = (placement == NumaPlacement::Local) ? 1 : VectorNuma::node_count();
+	Vector<std::size_t> constructedEnd(sliceCount);
+
+	auto constructSlice = [&](std::size_t sliceIndex, std::size_t first, std::size_t last)
+	{
+		std::size_t& constructed = constructedEnd[sliceIndex];
+
+		for (constructed = first; constructed < last; ++constructed)
+		{
+			::new(static_cast<void*>(container + constructed)) T(generator(constructed));
+		}
+	};
+
+	VECTOR_TRY
+	{
+		if (sliceCount == 1)
+		{
+			constructSlice(0, 0, count);
+		}
+		else
+		{
+			VectorNuma::run_per_node([&](std::size_t nodeIndex, int)
+			{
+				const auto slice = VectorNuma::node_slice(nodeIndex, sliceCount, count, sizeof(T));
+				constructSlice(nodeIndex, slice.first, slice.second);
+			});
+		}
+	}
+	VECTOR_CATCH_ALL
+	{
+		for (std::size_t sliceIndex = 0; sliceIndex < sliceCount; ++sliceIndex)
+		{
+			const std::size_t first = (sliceCount == 1) ? 0 : VectorNuma::node_slice(sliceIndex, sliceCount, count, sizeof(T)).first;
+			std::destroy(container + first, container + std::max(first, constructedEnd[sliceIndex]));
+		}
+
+		vector_type::deallocate_buffer(container, count);
+		VECTOR_RETHROW;
+	}
+
+	vector_type result;
+	result.adopt(container, count, count);
+
+	return result;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// numa_make_vector
+///
+/// The NUMA-placed counterpart of Vector(count): count value-initialized
+/// elements.
+///
+template<typename T, typename SizeType = std::size_t>
+Vector<T, SizeType> numa_make_vector(const SizeType count, NumaPlacement placement)
+{
+	return numa_generate_vector<T, SizeType>(count, placement, [](std::size_t) { return T(); });
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// numa_reserve
+///
+/// The NUMA-placed counterpart of Vector::reserve. The new buffer's pages are
+/// placed (and touched) before the existing elements are moved in, so later
+/// push_backs fill pages that already live on the intended nodes. Offers the
+/// same guarantee as reserve: if relocating an element throws, the vector
+/// keeps its old buffer.
+///
+template<typename T, typename SizeType>
+void numa_reserve(Vector<T, SizeType>& vector, const SizeType newCapacity, NumaPlacement placement)
+{
+	typedef Vector<T, SizeType> vector_type;
+
+	if (newCapacity <= vector.capacity())
+	{
+		return;
+	}
+
+	T* container = VectorNuma::allocate_pages<T>(newCapacity);
+
+	if (placement == NumaPlacement::Interleave)
+	{
+		VectorNuma::interleave(container, sizeof(T) * newCapacity);
+	}
+	else if (placement == NumaPlacement::FirstTouchPerNode)
+	{
+		VectorNuma::first_touch_per_node(container, sizeof(T) * newCapacity);
+	}
+
+	typename vector_type::buffer_type old = vector.release();
+
+	VECTOR_TRY
+	{
+		if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>)
+		{
+			std::uninitialized_move(old.data, old.data + old.size, container);
+		}
+		else
+		{
+			std::uninitialized_copy(old.data, old.data + old.size, container);
+		}
+	}
+	VECTOR_CATCH_ALL
+	{
+		vector_type::deallocate_buffer(container, newCapacity);
+		vector.adopt(old.data, old.size, old.capacity);
+		VECTOR_RETHROW;
+	}
+
+	std::destroy(old.data, old.data + old.size);
+
+	if (old.data)
+	{
+		old.deleter(old.data, old.capacity);
+	}
+
+	vector.adopt(container, old.size, newCapacity);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// numa_page_nodes
+///
+/// Reports which node holds each page of a Vector's buffer, see
+/// VectorNuma::page_nodes.
+///
+template<typename T, typename SizeType>
+Vector<int> numa_page_nodes(const Vector<T, SizeType>& vector)
+{
+	return VectorNuma::page_nodes(vector.data(), sizeof(T) * vector.capacity());
+}
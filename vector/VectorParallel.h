@@ -0,0 +1,664 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include "Vector.h"
+
+///////////////////////////////////////////////////////////////////////////////
+/// VectorThreadPool
+///
+/// The work-stealing pool behind the parallel algorithms. It starts on first
+/// use with sMaximumThreads - 1 workers (hardware_concurrency() - 1 when 0),
+/// and the thread that calls parallel_for is the last participant.
+///
+/// Every thread owns a queue of index ranges. A thread works through its range
+/// grain elements at a time, and whenever its queue has run dry it first
+/// splits the untouched upper half of the range off onto it. Idle threads
+/// steal from the front of other queues, where the largest pieces are, so a
+/// range is only cut as finely as stealing demands: uneven or unpredictable
+/// per-element cost balances out without a tuned chunk size, while a balanced
+/// loop on a busy machine is split only a few times. Threads other than the
+/// workers share one queue.
+///
+/// A thread waiting for its loop to finish runs queued pieces of any loop,
+/// so the body of a parallel loop may start parallel loops of its own.
+///
+class VectorThreadPool
+{
+public:
+	static constexpr std::size_t kMinimumGrain = 1 << 11;
+
+	/// Upper bound on the threads the pool uses, read when it starts; 0 means
+	/// hardware_concurrency().
+	static inline std::size_t sMaximumThreads = 0;
+
+	static VectorThreadPool& instance()
+	{
+		static VectorThreadPool pool(sMaximumThreads ? sMaximumThreads : std::max(1u, std::thread::hardware_concurrency()));
+		return pool;
+	}
+
+	~VectorThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_sleepMutex);
+			_stopping = true;
+		}
+
+		_wake.notify_all();
+
+		for (std::thread& worker : _workers)
+		{
+			worker.join();
+		}
+	}
+
+	/// Threads that take part in a loop, the calling thread included.
+	std::size_t thread_count() const noexcept
+	{
+		return _workers.size() + 1;
+	}
+
+	/// Calls body(begin, end) on disjoint ranges that together cover
+	/// [0, count), at most max(grain, 1) elements each, and returns when all
+	/// have run. A grain of 0 picks one from count and thread_count(). The
+	/// first exception a body throws is rethrown here; ranges that hadn't
+	/// started by then are skipped.
+	template<typename Body>
+	void parallel_for(std::size_t count, std::size_t grain, Body&& body)
+	{
+		if (grain == 0)
+		{
+			grain = std::max(kMinimumGrain, count / (thread_count() * 64));
+		}
+
+		if (count <= grain || _workers.empty())
+		{
+			if (count > 0)
+			{
+				body(std::size_t(0), count);
+			}
+
+			return;
+		}
+
+		typedef std::remove_reference_t<Body> body_type;
+
+		job loop;
+		loop.run = [](void* function, std::size_t begin, std::size_t end)
+		{
+			(*static_cast<body_type*>(function))(begin, end);
+		};
+		loop.body = const_cast<void*>(static_cast<const void*>(std::addressof(body)));
+		loop.grain = grain;
+		loop.remaining.store(count, std::memory_order_relaxed);
+
+		const std::size_t slot = current_slot();
+
+		execute(task{ &loop, 0, count }, slot);
+
+		while (loop.remaining.load(std::memory_order_acquire) != 0)
+		{
+			if (!run_one(slot))
+			{
+				std::this_thread::yield();
+			}
+		}
+
+		if (loop.error)
+		{
+			std::rethrow_exception(loop.error);
+		}
+	}
+
+private:
+	struct job
+	{
+		void (*run)(void* body, std::size_t begin, std::size_t end);
+		void* body;
+		std::size_t grain;
+		std::atomic<std::size_t> remaining;
+		std::atomic<bool> failed{ false };
+		std::exception_ptr error;
+	};
+
+	struct task
+	{
+		job* owner;
+		std::size_t begin;
+		std::size_t end;
+	};
+
+	struct queue
+	{
+		std::mutex mutex;
+		std::deque<task> tasks;
+		std::atomic<std::size_t> size{ 0 };
+	};
+
+	explicit VectorThreadPool(std::size_t threadCount)
+		:
+		_queues(new queue[threadCount]),
+		_queueCount(threadCount)
+	{
+		_workers.reserve(threadCount - 1);
+
+		for (std::size_t slot = 1; slot < threadCount; ++slot)
+		{
+			_workers.emplace_back(&VectorThreadPool::work, this, slot);
+		}
+	}
+
+	VectorThreadPool(const VectorThreadPool&) = delete;
+	VectorThreadPool& operator=(const VectorThreadPool&) = delete;
+
+	// The queue of the calling thread: its own for workers, the shared queue 0
+	// for everybody else.
+	static std::size_t& current_slot() noexcept
+	{
+		static thread_local std::size_t slot = 0;
+		return slot;
+	}
+
+	void work(std::size_t slot)
+	{
+		current_slot() = slot;
+
+		for (;;)
+		{
+			if (run_one(slot))
+			{
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(_sleepMutex);
+			_wake.wait(lock, [this]() { return _stopping || _queued.load(std::memory_order_acquire) > 0; });
+
+			if (_stopping)
+			{
+				return;
+			}
+		}
+	}
+
+	// Runs the newest piece of the thread's own queue, or else the oldest of
+	// the first other queue that has one; returns false if all were empty.
+	bool run_one(std::size_t slot)
+	{
+		task next;
+
+		if (pop(slot, next, false))
+		{
+			execute(next, slot);
+			return true;
+		}
+
+		for (std::size_t i = 1; i < _queueCount; ++i)
+		{
+			if (pop((slot + i) % _queueCount, next, true))
+			{
+				execute(next, slot);
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	void execute(task piece, std::size_t slot)
+	{
+		job& loop = *piece.owner;
+
+		while (piece.begin < piece.end)
+		{
+			if (piece.end - piece.begin >= 2 * loop.grain && _queues[slot].size.load(std::memory_order_relaxed) == 0)
+			{
+				const std::size_t middle = piece.begin + (piece.end - piece.begin) / 2;
+
+				if (push(slot, task{ &loop, middle, piece.end }))
+				{
+					piece.end = middle;
+					continue;
+				}
+			}
+
+			const std::size_t end = std::min(piece.end, piece.begin + loop.grain);
+
+			if (!loop.failed.load(std::memory_order_relaxed))
+			{
+				VECTOR_TRY
+				{
+					loop.run(loop.body, piece.begin, end);
+				}
+				VECTOR_CATCH_ALL
+				{
+					if (!loop.failed.exchange(true))
+					{
+						loop.error = std::current_exception();
+					}
+				}
+			}
+
+			// The last decrement releases the job to the waiting thread, so the
+			// job is not touched after it.
+			const std::size_t finished = end - piece.begin;
+			piece.begin = end;
+			loop.remaining.fetch_sub(finished, std::memory_order_acq_rel);
+		}
+	}
+
+	// A piece that can't be queued is simply run by the thread that split it.
+	bool push(std::size_t slot, const task& piece) noexcept
+	{
+		queue& target = _queues[slot];
+
+		{
+			std::lock_guard<std::mutex> lock(target.mutex);
+
+			VECTOR_TRY
+			{
+				target.tasks.push_back(piece);
+			}
+			VECTOR_CATCH_ALL
+			{
+				return false;
+			}
+
+			target.size.store(target.tasks.size(), std::memory_order_relaxed);
+		}
+
+		_queued.fetch_add(1, std::memory_order_release);
+
+		// Taking the sleep mutex orders the increment before any worker's
+		// decision to sleep.
+		{
+			std::lock_guard<std::mutex> lock(_sleepMutex);
+		}
+
+		_wake.notify_one();
+
+		return true;
+	}
+
+	bool pop(std::size_t slot, task& piece, bool steal) noexcept
+	{
+		queue& source = _queues[slot];
+
+		if (source.size.load(std::memory_order_relaxed) == 0)
+		{
+			return false;
+		}
+
+		std::lock_guard<std::mutex> lock(source.mutex);
+
+		if (source.tasks.empty())
+		{
+			return false;
+		}
+
+		if (steal)
+		{
+			piece = source.tasks.front();
+			source.tasks.pop_front();
+		}
+		else
+		{
+			piece = source.tasks.back();
+			source.tasks.pop_back();
+		}
+
+		source.size.store(source.tasks.size(), std::memory_order_relaxed);
+		_queued.fetch_sub(1, std::memory_order_relaxed);
+
+		return true;
+	}
+
+private:
+	std::unique_ptr<queue[]> _queues;
+	std::size_t _queueCount;
+	Vector<std::thread> _workers;
+	std::atomic<std::size_t> _queued{ 0 };
+	std::mutex _sleepMutex;
+	std::condition_variable _wake;
+	bool _stopping = false;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+/// VectorParallel
+///
+/// Helpers shared by the parallel algorithms. Reductions, scans and
+/// parallel_copy_if work on fixed blocks, so that partial results combine in
+/// element order and an operation only needs to be associative, not
+/// commutative.
+///
+class VectorParallel
+{
+public:
+	/// Elements per block for a blocked algorithm over count elements.
+	static std::size_t block_size(std::size_t count)
+	{
+		const std::size_t threads = VectorThreadPool::instance().thread_count();
+
+		return std::max(VectorThreadPool::kMinimumGrain, (count + threads * 8 - 1) / (threads * 8));
+	}
+
+	/// A Vector of count elements for an algorithm to assign. Trivial types
+	/// are left uninitialised rather than zeroed on the calling thread; others
+	/// are value-initialised.
+	template<typename T, typename SizeType>
+	static Vector<T, SizeType> make_output(std::size_t count)
+	{
+		if constexpr (std::is_trivial_v<T>)
+		{
+			Vector<T, SizeType> output;
+			const SizeType size = static_cast<SizeType>(count);
+
+			output.adopt(Vector<T, SizeType>::allocate_buffer(size), size, size);
+
+			return output;
+		}
+		else
+		{
+			return Vector<T, SizeType>(static_cast<SizeType>(count));
+		}
+	}
+
+	// With init, an exclusive scan seeded with *init; without, an inclusive one.
+	template<typename T, typename SizeType, typename BinaryOperation>
+	static Vector<T, SizeType> scan(const Vector<T, SizeType>& input, const T* init, BinaryOperation operation)
+	{
+		const std::size_t count = input.size();
+		Vector<T, SizeType> output = make_output<T, SizeType>(count);
+
+		if (count == 0)
+		{
+			return output;
+		}
+
+		const T* in = input.data();
+		T* out = output.data();
+		const std::size_t blockSize = block_size(count);
+		const std::size_t blocks = (count + blockSize - 1) / blockSize;
+
+		Vector<T> carries;
+		carries.assign(blocks, in[0]);
+
+		VectorThreadPool::instance().parallel_for(blocks - 1, 1, [&](std::size_t first, std::size_t last)
+		{
+			for (std::size_t block = first; block < last; ++block)
+			{
+				const std::size_t begin = block * blockSize;
+				T sum = in[begin];
+
+				for (std::size_t i = begin + 1; i < begin + blockSize; ++i)
+				{
+					sum = operation(sum, in[i]);
+				}
+
+				carries[block] = std::move(sum);
+			}
+		});
+
+		// Turns the block sums into what precedes each block.
+		if (blocks > 1 || init)
+		{
+			T running = init ? *init : carries[0];
+
+			for (std::size_t block = init ? 0 : 1; block < blocks; ++block)
+			{
+				T next = block + 1 < blocks ? operation(running, carries[block]) : running;
+				carries[block] = std::move(running);
+				running = std::move(next);
+			}
+		}
+
+		VectorThreadPool::instance().parallel_for(blocks, 1, [&](std::size_t first, std::size_t last)
+		{
+			for (std::size_t block = first; block < last; ++block)
+			{
+				const std::size_t begin = block * blockSize;
+				const std::size_t end = std::min(count, begin + blockSize);
+
+				if (init)
+				{
+					T sum = carries[block];
+
+					for (std::size_t i = begin; i < end; ++i)
+					{
+						T next = operation(sum, in[i]);
+						out[i] = std::move(sum);
+						sum = std::move(next);
+					}
+				}
+				else
+				{
+					T sum = block == 0 ? in[begin] : operation(carries[block], in[begin]);
+					out[begin] = sum;
+
+					for (std::size_t i = begin + 1; i < end; ++i)
+					{
+						sum = operation(sum, in[i]);
+						out[i] = sum;
+					}
+				}
+			}
+		});
+
+		return output;
+	}
+};
+
+///////////////////////////////////////////////////////////////////////////////
+/// parallel_for_each
+///
+/// Calls function(element) for every element, concurrently on the pool's
+/// threads and in no particular order.
+///
+template<typename T, typename SizeType, typename Function>
+void parallel_for_each(Vector<T, SizeType>& vector, Function function)
+{
+	T* data = vector.data();
+
+	VectorThreadPool::instance().parallel_for(vector.size(), 0, [data, &function](std::size_t begin, std::size_t end)
+	{
+		for (std::size_t i = begin; i < end; ++i)
+		{
+			function(data[i]);
+		}
+	});
+}
+
+template<typename T, typename SizeType, typename Function>
+void parallel_for_each(const Vector<T, SizeType>& vector, Function function)
+{
+	const T* data = vector.data();
+
+	VectorThreadPool::instance().parallel_for(vector.size(), 0, [data, &function](std::size_t begin, std::size_t end)
+	{
+		for (std::size_t i = begin; i < end; ++i)
+		{
+			function(data[i]);
+		}
+	});
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// parallel_transform
+///
+/// Returns the Vector of function(element) for every element, computed in
+/// parallel. Results that aren't trivial types must be default constructible.
+///
+template<typename T, typename SizeType, typename Function>
+auto parallel_transform(const Vector<T, SizeType>& input, Function function)
+	-> Vector<std::decay_t<std::invoke_result_t<Function&, const T&>>, SizeType>
+{
+	typedef std::decay_t<std::invoke_result_t<Function&, const T&>> result_type;
+
+	Vector<result_type, SizeType> output = VectorParallel::make_output<result_type, SizeType>(input.size());
+	const T* in = input.data();
+	result_type* out = output.data();
+
+	VectorThreadPool::instance().parallel_for(input.size(), 0, [in, out, &function](std::size_t begin, std::size_t end)
+	{
+		for (std::size_t i = begin; i < end; ++i)
+		{
+			out[i] = function(in[i]);
+		}
+	});
+
+	return output;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// parallel_reduce
+///
+/// Folds the elements into init with operation, which must be associative.
+/// Blocks are reduced in parallel and their results combined in order, so the
+/// result doesn't depend on the thread count for exact arithmetic.
+///
+template<typename T, typename SizeType, typename BinaryOperation = std::plus<>>
+T parallel_reduce(const Vector<T, SizeType>& input, typename Vector<T, SizeType>::value_type init, BinaryOperation operation = BinaryOperation())
+{
+	const std::size_t count = input.size();
+
+	if (count == 0)
+	{
+		return init;
+	}
+
+	const T* in = input.data();
+	const std::size_t blockSize = VectorParallel::block_size(count);
+	const std::size_t blocks = (count + blockSize - 1) / blockSize;
+
+	Vector<T> partials;
+	partials.assign(blocks, in[0]);
+
+	VectorThreadPool::instance().parallel_for(blocks, 1, [&](std::size_t first, std::size_t last)
+	{
+		for (std::size_t block = first; block < last; ++block)
+		{
+			const std::size_t begin = block * blockSize;
+			const std::size_t end = std::min(count, begin + blockSize);
+			T sum = in[begin];
+
+			for (std::size_t i = begin + 1; i < end; ++i)
+			{
+				sum = operation(sum, in[i]);
+			}
+
+			partials[block] = std::move(sum);
+		}
+	});
+
+	for (const T& partial : partials)
+	{
+		init = operation(init, partial);
+	}
+
+	return init;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// parallel_inclusive_scan, parallel_exclusive_scan
+///
+/// Prefix sums with an associative operation: element i of the result folds
+/// elements [0, i] (inclusive) or init and elements [0, i) (exclusive). Three
+/// passes: block sums in parallel, a scan over the block sums, then every
+/// block scanned in parallel from its carry.
+///
+template<typename T, typename SizeType, typename BinaryOperation = std::plus<>>
+Vector<T, SizeType> parallel_inclusive_scan(const Vector<T, SizeType>& input, BinaryOperation operation = BinaryOperation())
+{
+	return VectorParallel::scan(input, static_cast<const T*>(nullptr), operation);
+}
+
+template<typename T, typename SizeType, typename BinaryOperation = std::plus<>>
+Vector<T, SizeType> parallel_exclusive_scan(const Vector<T, SizeType>& input, typename Vector<T, SizeType>::value_type init, BinaryOperation operation = BinaryOperation())
+{
+	return VectorParallel::scan(input, &init, operation);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// parallel_copy_if
+///
+/// Returns the elements for which predicate(element) holds, in their original
+/// order. The predicate runs once per element in parallel; a prefix sum over
+/// the per-block match counts then gives every block the offset to copy its
+/// matches to, so the copy is parallel as well. Elements that aren't trivial
+/// types must be default constructible.
+///
+template<typename T, typename SizeType, typename Predicate>
+Vector<T, SizeType> parallel_copy_if(const Vector<T, SizeType>& input, Predicate predicate)
+{
+	const std::size_t count = input.size();
+
+	if (count == 0)
+	{
+		return Vector<T, SizeType>();
+	}
+
+	const T* in = input.data();
+	const std::size_t blockSize = VectorParallel::block_size(count);
+	const std::size_t blocks = (count + blockSize - 1) / blockSize;
+
+	Vector<unsigned char> matches = VectorParallel::make_output<unsigned char, std::size_t>(count);
+	Vector<std::size_t> offsets = VectorParallel::make_output<std::size_t, std::size_t>(blocks);
+
+	VectorThreadPool::instance().parallel_for(blocks, 1, [&](std::size_t first, std::size_t last)
+	{
+		for (std::size_t block = first; block < last; ++block)
+		{
+			const std::size_t begin = block * blockSize;
+			const std::size_t end = std::min(count, begin + blockSize);
+			std::size_t matched = 0;
+
+			for (std::size_t i = begin; i < end; ++i)
+			{
+				const bool match = static_cast<bool>(predicate(in[i]));
+				matches[i] = match;
+				matched += match;
+			}
+
+			offsets[block] = matched;
+		}
+	});
+
+	std::size_t total = 0;
+
+	for (std::size_t& offset : offsets)
+	{
+		total += std::exchange(offset, total);
+	}
+
+	Vector<T, SizeType> output = VectorParallel::make_output<T, SizeType>(total);
+	T* out = output.data();
+
+	VectorThreadPool::instance().parallel_for(blocks, 1, [&](std::size_t first, std::size_t last)
+	{
+		for (std::size_t block = first; block < last; ++block)
+		{
+			const std::size_t end = std::min(count, (block + 1) * blockSize);
+			std::size_t position = offsets[block];
+
+			for (std::size_t i = block * blockSize; i < end; ++i)
+			{
+				if (matches[i])
+				{
+					out[position++] = in[i];
+				}
+			}
+		}
+	});
+
+	return output;
+}
@@ -0,0 +1,195 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+// Counters are read through the perf_event_open system call; other platforms
+// build the same API with no events available.
+#if defined(__linux__)
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define VECTOR_PERF_LINUX 1
+#else
+#define VECTOR_PERF_LINUX 0
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+/// VectorPerfCounters
+///
+/// Hardware performance counters for the calling thread, for benchmarks that
+/// need to explain a timing: cycles, instructions, L1 data and last level
+/// cache read misses, data TLB read misses and branch misses, counted in user
+/// space only.
+///
+/// The counters come from Linux perf_event_open. Each event is opened on its
+/// own, so a CPU that lacks one (or a virtual machine that exposes none)
+/// leaves only that event invalid; available() is false when no event could
+/// be opened, including on other platforms and when perf_event_paranoid
+/// forbids it. When the PMU has fewer counters than events the kernel time
+/// shares them, and readings are scaled up by enabled / running time.
+///
+///    VectorPerfCounters counters;
+///    VectorPerfCounters::reading r = counters.measure([&]() { v.insert(v.begin(), x); });
+///    if (r.valid[VectorPerfCounters::kCycles]) { ... r.values[VectorPerfCounters::kCycles] ... }
+///
+class VectorPerfCounters
+{
+public:
+	enum event
+	{
+		kCycles,
+		kInstructions,
+		kL1DataMisses,
+		kLastLevelMisses,
+		kDataTlbMisses,
+		kBranchMisses,
+		kEventCount
+	};
+
+	struct reading
+	{
+		std::array<double, kEventCount> values;
+		std::array<bool, kEventCount> valid;
+	};
+
+	VectorPerfCounters() noexcept
+	{
+		_descriptors.fill(-1);
+
+#if VECTOR_PERF_LINUX
+		constexpr std::uint64_t cacheReadMiss = (std::uint64_t(PERF_COUNT_HW_CACHE_OP_READ) << 8) | (std::uint64_t(PERF_COUNT_HW_CACHE_RESULT_MISS) << 16);
+
+		const std::pair<std::uint32_t, std::uint64_t> events[kEventCount] =
+		{
+			{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+			{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+			{ PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | cacheReadMiss },
+			{ PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL | cacheReadMiss },
+			{ PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB | cacheReadMiss },
+			{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+		};
+
+		for (std::size_t i = 0; i < kEventCount; ++i)
+		{
+			perf_event_attr attributes;
+			std::memset(&attributes, 0, sizeof(attributes));
+
+			attributes.size = sizeof(attributes);
+			attributes.type = events[i].first;
+			attributes.config = events[i].second;
+			attributes.disabled = 1;
+			attributes.exclude_kernel = 1;
+			attributes.exclude_hv = 1;
+			attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+			_descriptors[i] = static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+		}
+#endif
+	}
+
+	~VectorPerfCounters()
+	{
+#if VECTOR_PERF_LINUX
+		for (int descriptor : _descriptors)
+		{
+			if (descriptor >= 0)
+			{
+				close(descriptor);
+			}
+		}
+#endif
+	}
+
+	VectorPerfCounters(const VectorPerfCounters&) = delete;
+	VectorPerfCounters& operator=(const VectorPerfCounters&) = delete;
+
+	bool available() const noexcept
+	{
+		for (int descriptor : _descriptors)
+		{
+			if (descriptor >= 0)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	bool available(event counter) const noexcept
+	{
+		return _descriptors[counter] >= 0;
+	}
+
+	static const char* name(event counter) noexcept
+	{
+		static const char* const names[kEventCount] =
+		{
+			"cycles", "instructions", "L1D misses", "LLC misses", "dTLB misses", "branch misses"
+		};
+
+		return names[counter];
+	}
+
+	/// Zeroes and starts every counter.
+	void start() noexcept
+	{
+#if VECTOR_PERF_LINUX
+		for (int descriptor : _descriptors)
+		{
+			if (descriptor >= 0)
+			{
+				ioctl(descriptor, PERF_EVENT_IOC_RESET, 0);
+				ioctl(descriptor, PERF_EVENT_IOC_ENABLE, 0);
+			}
+		}
+#endif
+	}
+
+	/// Stops the counters and returns what they counted since start(). An
+	/// event is invalid if it isn't available or never got scheduled on the PMU.
+	reading stop() noexcept
+	{
+		reading result = {};
+
+#if VECTOR_PERF_LINUX
+		for (int descriptor : _descriptors)
+		{
+			if (descriptor >= 0)
+			{
+				ioctl(descriptor, PERF_EVENT_IOC_DISABLE, 0);
+			}
+		}
+
+		for (std::size_t i = 0; i < kEventCount; ++i)
+		{
+			std::uint64_t values[3] = {};  // count, time enabled, time running
+
+			if (_descriptors[i] >= 0 && read(_descriptors[i], values, sizeof(values)) == static_cast<ssize_t>(sizeof(values)) && values[2] > 0)
+			{
+				result.values[i] = static_cast<double>(values[0]) * static_cast<double>(values[1]) / static_cast<double>(values[2]);
+				result.valid[i] = true;
+			}
+		}
+#endif
+
+		return result;
+	}
+
+	template<typename Function>
+	reading measure(Function&& function)
+	{
+		start();
+		function();
+
+		return stop();
+	}
+
+private:
+	std::array<int, kEventCount> _descriptors;
+};
@@ -0,0 +1,257 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Vector.h"
+
+///////////////////////////////////////////////////////////////////////////////
+/// VectorReclaimer
+///
+/// Opt-in background freeing of huge buffers. Returning a multi-gigabyte
+/// buffer to the system unmaps its pages, which takes milliseconds; while the
+/// reclaimer is enabled, Vectors hand buffers of at least the threshold size
+/// to a reclamation thread instead of freeing them on the thread that
+/// destroys, clears or move-assigns the Vector. The elements are gone by then,
+/// so nothing but the memory outlives the Vector.
+///
+/// The reclaimer plugs into Vector through VectorAllocationHooks::release
+/// when this header is included. Until enable() is called it neither starts
+/// a thread nor constructs any state, and a Vector released after the
+/// reclaimer was destroyed at exit is freed inline.
+///
+/// At most maxQueuedBuffers buffers wait for the thread. Past that, buffers
+/// are freed inline as usual, so a burst of releases is never held up by the
+/// queue and memory in flight stays bounded. flush() waits until every
+/// queued buffer has been freed, and disable() flushes before it stops the
+/// thread. VectorAllocationHooks see a deferred buffer when it is handed
+/// over, not when the thread frees it.
+///
+/// enable() and disable() may be called from any thread but are meant for
+/// start-up and shutdown; releasing buffers is safe from any number of threads.
+///
+class VectorReclaimer
+{
+public:
+	static constexpr std::size_t kDefaultThreshold = std::size_t(64) << 20;
+	static constexpr std::size_t kDefaultMaxQueuedBuffers = 16;
+
+	struct statistics
+	{
+		std::size_t deferred;        // buffers handed to the reclamation thread
+		std::size_t freedInline;     // buffers over the threshold freed inline because the queue was full
+		std::size_t queuedBuffers;   // buffers handed over and not yet freed
+		std::size_t queuedBytes;
+	};
+
+	/// Starts the reclamation thread, or changes the settings of a running one.
+	static void enable(std::size_t thresholdBytes = kDefaultThreshold, std::size_t maxQueuedBuffers = kDefaultMaxQueuedBuffers)
+	{
+		state_type& reclaimer = state();
+		std::lock_guard<std::mutex> control(reclaimer.controlMutex);
+
+		if (!reclaimer.worker.joinable())
+		{
+			reclaimer.worker = std::thread(&VectorReclaimer::run, std::ref(reclaimer));
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(reclaimer.mutex);
+
+			reclaimer.queue.reserve(maxQueuedBuffers);
+			reclaimer.maxQueuedBuffers = maxQueuedBuffers;
+			reclaimer.accepting = true;
+		}
+
+		sThreshold.store(std::max<std::size_t>(thresholdBytes, 1), std::memory_order_relaxed);
+	}
+
+	/// Frees every queued buffer and stops the reclamation thread.
+	static void disable() noexcept
+	{
+		stop(state());
+	}
+
+	static bool enabled() noexcept
+	{
+		return sThreshold.load(std::memory_order_relaxed) != kDisabled;
+	}
+
+	/// Returns once every buffer handed over so far has been freed.
+	static void flush() noexcept
+	{
+		state_type& reclaimer = state();
+		std::unique_lock<std::mutex> lock(reclaimer.mutex);
+
+		reclaimer.drained.wait(lock, [&reclaimer]() { return reclaimer.queue.empty() && reclaimer.freeing == 0; });
+	}
+
+	static statistics stats() noexcept
+	{
+		state_type& reclaimer = state();
+		std::lock_guard<std::mutex> lock(reclaimer.mutex);
+
+		return reclaimer.stats;
+	}
+
+	static void reset_stats() noexcept
+	{
+		state_type& reclaimer = state();
+		std::lock_guard<std::mutex> lock(reclaimer.mutex);
+
+		reclaimer.stats.deferred = 0;
+		reclaimer.stats.freedInline = 0;
+	}
+
+	/// Queues a buffer from _aligned_malloc for the reclamation thread; returns
+	/// false if the caller has to free it because the reclaimer is disabled,
+	/// the buffer is below the threshold or the queue is full.
+	static bool defer(void* buffer, std::size_t bytes) noexcept
+	{
+		if (buffer == nullptr || bytes < sThreshold.load(std::memory_order_relaxed))
+		{
+			return false;
+		}
+
+		state_type& reclaimer = state();
+
+		{
+			std::lock_guard<std::mutex> lock(reclaimer.mutex);
+
+			if (!reclaimer.accepting)
+			{
+				return false;
+			}
+
+			if (reclaimer.queue.size() >= reclaimer.maxQueuedBuffers)
+			{
+				reclaimer.stats.freedInline += 1;
+
+				return false;
+			}
+
+			reclaimer.queue.push_back(entry{ buffer, bytes });
+			reclaimer.stats.deferred += 1;
+			reclaimer.stats.queuedBuffers += 1;
+			reclaimer.stats.queuedBytes += bytes;
+		}
+
+		reclaimer.wake.notify_one();
+
+		return true;
+	}
+
+private:
+	static constexpr std::size_t kDisabled = std::numeric_limits<std::size_t>::max();
+
+	// Kept out of state_type: it is constant initialized and trivially
+	// destructible, so defer() can check it before the state exists and after
+	// it was destroyed.
+	static inline std::atomic<std::size_t> sThreshold{ kDisabled };
+
+	struct entry
+	{
+		void* buffer;
+		std::size_t bytes;
+	};
+
+	struct state_type
+	{
+		~state_type()
+		{
+			stop(*this);
+		}
+
+		std::mutex controlMutex;
+		std::mutex mutex;
+		std::condition_variable wake;
+		std::condition_variable drained;
+		std::thread worker;
+		std::vector<entry> queue;
+		std::size_t maxQueuedBuffers = 0;
+		std::size_t freeing = 0;
+		bool accepting = false;
+		bool stopping = false;
+		statistics stats = {};
+	};
+
+	static state_type& state() noexcept
+	{
+		static state_type reclaimer;
+		return reclaimer;
+	}
+
+	static void stop(state_type& reclaimer) noexcept
+	{
+		std::lock_guard<std::mutex> control(reclaimer.controlMutex);
+
+		sThreshold.store(kDisabled, std::memory_order_relaxed);
+
+		if (!reclaimer.worker.joinable())
+		{
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(reclaimer.mutex);
+
+			reclaimer.accepting = false;
+			reclaimer.stopping = true;
+		}
+
+		reclaimer.wake.notify_one();
+		reclaimer.worker.join();
+		reclaimer.stopping = false;
+	}
+
+	// The queue is the only state shared with releasing threads; buffers are
+	// freed outside the lock so that they never wait on an unmap.
+	static void run(state_type& reclaimer) noexcept
+	{
+		std::unique_lock<std::mutex> lock(reclaimer.mutex);
+
+		for (;;)
+		{
+			reclaimer.wake.wait(lock, [&reclaimer]() { return reclaimer.stopping || !reclaimer.queue.empty(); });
+
+			if (reclaimer.queue.empty())
+			{
+				return;
+			}
+
+			const entry queued = reclaimer.queue.back();
+			reclaimer.queue.pop_back();
+			reclaimer.freeing += 1;
+
+			lock.unlock();
+			_aligned_free(queued.buffer);
+			lock.lock();
+
+			reclaimer.freeing -= 1;
+			reclaimer.stats.queuedBuffers -= 1;
+			reclaimer.stats.queuedBytes -= queued.bytes;
+
+			if (reclaimer.queue.empty() && reclaimer.freeing == 0)
+			{
+				reclaimer.drained.notify_all();
+			}
+		}
+	}
+};
+
+// Plugs the reclaimer into every Vector of the program during static
+// initialization.
+inline bool vector_reclaimer_install() noexcept
+{
+	VectorAllocationHooks::release = &VectorReclaimer::defer;
+
+	return true;
+}
+
+inline const bool kVectorReclaimerInstalled = vector_reclaimer_install();
@@ -0,0 +1,568 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include "Vector.h"
+
+///////////////////////////////////////////////////////////////////////////////
+/// VectorSizingProfile
+///
+/// Learns how large the Vectors created at a call site get, so that the next
+/// Vector for the same site (or the next run, via save() and load()) can
+/// start at that capacity instead of doubling its way up. ProfiledVector
+/// reports to it; nothing else does, so the profile costs nothing unless
+/// ProfiledVector is used.
+///
+/// Each call site is a site object, looked up by key once and kept for the
+/// life of the program; VECTOR_PROFILE_SITE caches it in a static at the call
+/// site, after which reading and updating its hint is a few atomic operations
+/// with no lock and no string.
+///
+/// Each key keeps the largest peak size recorded for it. Hints only ever
+/// grow; reset() or editing the saved file is the way to lower one.
+///
+/// The statistics compare the allocations profiled Vectors needed to reach
+/// their peak with the allocations doubling from empty would have needed,
+/// both estimated from Vector's growth policy (capacity max(2, 2 * capacity)).
+///
+class VectorSizingProfile
+{
+public:
+	struct statistics
+	{
+		std::size_t vectors;                // profiled Vectors recorded
+		std::size_t hintedVectors;          // of which started at a learned capacity
+		std::size_t growthAllocations;      // allocations they needed to reach their peak
+		std::size_t baselineAllocations;    // allocations growth from empty would have needed
+	};
+
+	class site
+	{
+	public:
+		const char* key() const noexcept
+		{
+			return _key;
+		}
+
+		/// The learned capacity, 0 if nothing was recorded.
+		std::size_t hint() const noexcept
+		{
+			return _hint.load(std::memory_order_relaxed);
+		}
+
+		/// Records that a Vector which started at initialCapacity reached
+		/// peakSize elements.
+		void record(std::size_t initialCapacity, std::size_t peakSize) noexcept
+		{
+			learn(peakSize);
+
+			counters& stats = state();
+			stats.vectors.fetch_add(1, std::memory_order_relaxed);
+			stats.hintedVectors.fetch_add(initialCapacity > 0 ? 1 : 0, std::memory_order_relaxed);
+			stats.growthAllocations.fetch_add(growth_allocations(initialCapacity, peakSize), std::memory_order_relaxed);
+			stats.baselineAllocations.fetch_add(growth_allocations(0, peakSize), std::memory_order_relaxed);
+		}
+
+	private:
+		friend class VectorSizingProfile;
+
+		void learn(std::size_t capacity) noexcept
+		{
+			std::size_t learned = _hint.load(std::memory_order_relaxed);
+
+			while (learned < capacity && !_hint.compare_exchange_weak(learned, capacity, std::memory_order_relaxed))
+			{
+			}
+		}
+
+		const char* _key = nullptr;
+		std::atomic<std::size_t> _hint{ 0 };
+	};
+
+	/// The site for key, created on first use. Sites are never destroyed, so
+	/// the reference can be cached.
+	static site& site_for(const char* key)
+	{
+		std::lock_guard<std::mutex> lock(mutex());
+
+		return site_for_locked(key);
+	}
+
+	/// The learned capacity for key, 0 if nothing was recorded for it.
+	static std::size_t hint(const char* key)
+	{
+		return site_for(key).hint();
+	}
+
+	/// Records that a Vector for key which started at initialCapacity reached
+	/// peakSize elements.
+	static void record(const char* key, std::size_t initialCapacity, std::size_t peakSize)
+	{
+		site_for(key).record(initialCapacity, peakSize);
+	}
+
+	/// Writes every hint as a "<capacity> <key>" line; returns false if the
+	/// file can't be written.
+	static bool save(const char* path)
+	{
+		std::lock_guard<std::mutex> lock(mutex());
+
+		std::ofstream file(path, std::ios::trunc);
+
+		for (const auto& [key, callSite] : sites())
+		{
+			if (const std::size_t capacity = callSite.hint())
+			{
+				file << capacity << ' ' << key << '\n';
+			}
+		}
+
+		return static_cast<bool>(file);
+	}
+
+	/// Merges the hints of a file written by save() into the profile; returns
+	/// false if the file can't be read. Malformed lines are skipped.
+	static bool load(const char* path)
+	{
+		std::ifstream file(path);
+
+		if (!file)
+		{
+			return false;
+		}
+
+		std::lock_guard<std::mutex> lock(mutex());
+
+		std::string line;
+
+		while (std::getline(file, line))
+		{
+			std::istringstream fields(line);
+			std::size_t capacity = 0;
+			std::string key;
+
+			if (fields >> capacity && std::getline(fields >> std::ws, key) && !key.empty())
+			{
+				site_for_locked(key.c_str()).learn(capacity);
+			}
+		}
+
+		return true;
+	}
+
+	static statistics stats() noexcept
+	{
+		const counters& stats = state();
+
+		return statistics{
+			stats.vectors.load(std::memory_order_relaxed),
+			stats.hintedVectors.load(std::memory_order_relaxed),
+			stats.growthAllocations.load(std::memory_order_relaxed),
+			stats.baselineAllocations.load(std::memory_order_relaxed) };
+	}
+
+	/// Forgets every hint and zeroes the statistics. The sites themselves stay,
+	/// since call sites may hold on to them.
+	static void reset()
+	{
+		std::lock_guard<std::mutex> lock(mutex());
+
+		for (auto& [key, callSite] : sites())
+		{
+			callSite._hint.store(0, std::memory_order_relaxed);
+		}
+
+		counters& stats = state();
+		stats.vectors.store(0, std::memory_order_relaxed);
+		stats.hintedVectors.store(0, std::memory_order_relaxed);
+		stats.growthAllocations.store(0, std::memory_order_relaxed);
+		stats.baselineAllocations.store(0, std::memory_order_relaxed);
+	}
+
+private:
+	struct counters
+	{
+		std::atomic<std::size_t> vectors{ 0 };
+		std::atomic<std::size_t> hintedVectors{ 0 };
+		std::atomic<std::size_t> growthAllocations{ 0 };
+		std::atomic<std::size_t> baselineAllocations{ 0 };
+	};
+
+	static std::size_t growth_allocations(std::size_t capacity, std::size_t size) noexcept
+	{
+		std::size_t allocations = capacity > 0 ? 1 : 0;
+
+		for (; capacity < size; allocations += 1)
+		{
+			capacity = std::max<std::size_t>(2, capacity * 2);
+		}
+
+		return allocations;
+	}
+
+	// The map is node based, so a site and its key keep their addresses.
+	static site& site_for_locked(const char* key)
+	{
+		const auto [entry, inserted] = sites().try_emplace(key);
+
+		if (inserted)
+		{
+			entry->second._key = entry->first.c_str();
+		}
+
+		return entry->second;
+	}
+
+	static std::unordered_map<std::string, site>& sites()
+	{
+		static std::unordered_map<std::string, site> callSites;
+		return callSites;
+	}
+
+	static counters& state()
+	{
+		static counters profileStats;
+		return profileStats;
+	}
+
+	static std::mutex& mutex()
+	{
+		static std::mutex profileMutex;
+		return profileMutex;
+	}
+};
+
+// The site for a string literal key, looked up once per call site.
+#define VECTOR_PROFILE_SITE(key) \
+	([]() -> VectorSizingProfile::site& { static VectorSizingProfile::site& cachedSite = VectorSizingProfile::site_for(key); return cachedSite; }())
+
+///////////////////////////////////////////////////////////////////////////////
+/// ProfiledVector
+///
+/// A Vector tagged with a call site. The first time it needs storage it
+/// reserves the capacity VectorSizingProfile learned for the site, and when it
+/// is cleared or destroyed it records the largest size it reached. Passing the
+/// site through VECTOR_PROFILE_SITE keeps construction and destruction lock
+/// free:
+///
+///    ProfiledVector<Token> tokens(VECTOR_PROFILE_SITE("Lexer::tokens"));
+///
+/// A plain key works too but looks the site up under the profile's lock
+/// every time. Only clear() and destruction are observed, so a Vector that
+/// shrinks through erase() before either reports less than its true peak.
+///
+/// The Vector is a private base, so a ProfiledVector can't be sliced or
+/// deleted through a Vector pointer; vector() gives read access to it for
+/// functions that take a Vector.
+///
+template<typename T, typename SizeType = std::size_t>
+class ProfiledVector : private Vector<T, SizeType>
+{
+public:
+	typedef                    Vector<T, SizeType> base_type;
+
+	using typename base_type::size_type;
+	using typename base_type::difference_type;
+	using typename base_type::value_type;
+	using typename base_type::iterator;
+	using typename base_type::const_iterator;
+	using typename base_type::reference;
+	using typename base_type::const_reference;
+	using typename base_type::pointer;
+	using typename base_type::const_pointer;
+
+public:
+	explicit ProfiledVector(VectorSizingProfile::site& site) noexcept;
+	explicit ProfiledVector(const char* key);
+	ProfiledVector(const ProfiledVector<T, SizeType>& other);
+	ProfiledVector(ProfiledVector<T, SizeType>&& other) noexcept(std::is_nothrow_move_constructible_v<base_type>);
+	~ProfiledVector();
+	ProfiledVector<T, SizeType>& operator=(const ProfiledVector<T, SizeType>& other);
+	ProfiledVector<T, SizeType>& operator=(ProfiledVector<T, SizeType>&& other) noexcept(std::is_nothrow_move_assignable_v<base_type>);
+
+public:
+	// Everything that may allocate goes through the hint first.
+	template<class... Args>
+	reference emplace_back(Args&& ... args);
+
+	void push_back(const T& element);
+	void push_back(T&& element);
+
+	iterator insert(const_iterator pos, const T& value);
+	iterator insert(const_iterator pos, T&& value);
+
+	template<class... Args>
+	iterator emplace(const_iterator pos, Args&& ... args);
+
+	template<typename InputIterator, typename = typename std::iterator_traits<InputIterator>::iterator_category>
+	void assign(InputIterator first, InputIterator last);
+	void assign(const std::size_t count, const T& value);
+
+	template<typename InputIterator, typename = typename std::iterator_traits<InputIterator>::iterator_category>
+	void append(InputIterator first, InputIterator last);
+	template<typename Range>
+	void append(const Range& range);
+
+	template<typename Generator>
+	void generate_back(const std::size_t count, Generator generator);
+
+	void reserve(const std::size_t newCapacity);
+
+	void clear() noexcept;
+
+	using base_type::erase;
+	using base_type::operator[];
+	using base_type::at;
+
+public:
+	using base_type::validate;
+	using base_type::empty;
+	using base_type::size;
+	using base_type::capacity;
+	using base_type::max_size;
+	using base_type::shrink_to;
+	using base_type::shrink_to_fit;
+
+	using base_type::begin;
+	using base_type::cbegin;
+	using base_type::end;
+	using base_type::cend;
+	using base_type::front;
+	using base_type::back;
+	using base_type::data;
+
+	const base_type& vector() const noexcept;
+	const char* key() const noexcept;
+
+private:
+	void reserve_hint(const std::size_t needed = 0);
+
+private:
+	VectorSizingProfile::site* _site;
+	size_type _initialCapacity;
+	size_type _peakSize;
+	bool _movedFrom;
+};
+
+template<typename T, typename SizeType>
+ProfiledVector<T, SizeType>::ProfiledVector(VectorSizingProfile::site& site) noexcept
+	:
+	_site(&site),
+	_initialCapacity(0),
+	_peakSize(0),
+	_movedFrom(false)
+{
+}
+
+template<typename T, typename SizeType>
+ProfiledVector<T, SizeType>::ProfiledVector(const char* key)
+	:
+	ProfiledVector(VectorSizingProfile::site_for(key))
+{
+}
+
+// A copy starts a history of its own; a move hands the history over, so that
+// the moved-from Vector doesn't report the same peak again, nor count as a
+// Vector of its own unless it is filled again.
+template<typename T, typename SizeType>
+ProfiledVector<T, SizeType>::ProfiledVector(const ProfiledVector<T, SizeType>& other)
+	:
+	base_type(other),
+	_site(other._site),
+	_initialCapacity(0),
+	_peakSize(0),
+	_movedFrom(false)
+{
+}
+
+template<typename T, typename SizeType>
+ProfiledVector<T, SizeType>::ProfiledVector(ProfiledVector<T, SizeType>&& other) noexcept(std::is_nothrow_move_constructible_v<base_type>)
+	:
+	base_type(std::move(other)),
+	_site(other._site),
+	_initialCapacity(std::exchange(other._initialCapacity, 0)),
+	_peakSize(std::exchange(other._peakSize, 0)),
+	_movedFrom(std::exchange(other._movedFrom, true))
+{
+}
+
+template<typename T, typename SizeType>
+ProfiledVector<T, SizeType>::~ProfiledVector()
+{
+	const std::size_t peakSize = std::max<std::size_t>(_peakSize, base_type::size());
+
+	if (_movedFrom && peakSize == 0)
+	{
+		return;
+	}
+
+	_site->record(_initialCapacity, peakSize);
+}
+
+template<typename T, typename SizeType>
+ProfiledVector<T, SizeType>& ProfiledVector<T, SizeType>::operator=(const ProfiledVector<T, SizeType>& other)
+{
+	_peakSize = std::max(_peakSize, base_type::size());
+	base_type::operator=(other);
+
+	return *this;
+}
+
+template<typename T, typename SizeType>
+ProfiledVector<T, SizeType>& ProfiledVector<T, SizeType>::operator=(ProfiledVector<T, SizeType>&& other) noexcept(std::is_nothrow_move_assignable_v<base_type>)
+{
+	_peakSize = std::max(_peakSize, base_type::size());
+	base_type::operator=(std::move(other));
+
+	return *this;
+}
+
+template<typename T, typename SizeType>
+template<class... Args>
+inline typename ProfiledVector<T, SizeType>::reference
+ProfiledVector<T, SizeType>::emplace_back(Args&& ... args)
+{
+	reserve_hint();
+
+	return base_type::emplace_back(std::forward<Args>(args)...);
+}
+
+template<typename T, typename SizeType>
+inline void ProfiledVector<T, SizeType>::push_back(const T& element)
+{
+	reserve_hint();
+	base_type::push_back(element);
+}
+
+template<typename T, typename SizeType>
+inline void ProfiledVector<T, SizeType>::push_back(T&& element)
+{
+	reserve_hint();
+	base_type::push_back(std::move(element));
+}
+
+// Reserving the hint reallocates, so positions are carried over as indices.
+template<typename T, typename SizeType>
+typename ProfiledVector<T, SizeType>::iterator
+ProfiledVector<T, SizeType>::insert(const_iterator pos, const T& value)
+{
+	const difference_type index = pos - cbegin();
+	reserve_hint();
+
+	return base_type::insert(cbegin() + index, value);
+}
+
+template<typename T, typename SizeType>
+typename ProfiledVector<T, SizeType>::iterator
+ProfiledVector<T, SizeType>::insert(const_iterator pos, T&& value)
+{
+	const difference_type index = pos - cbegin();
+	reserve_hint();
+
+	return base_type::insert(cbegin() + index, std::move(value));
+}
+
+template<typename T, typename SizeType>
+template<class... Args>
+typename ProfiledVector<T, SizeType>::iterator
+ProfiledVector<T, SizeType>::emplace(const_iterator pos, Args&& ... args)
+{
+	const difference_type index = pos - cbegin();
+	reserve_hint();
+
+	return base_type::emplace(cbegin() + index, std::forward<Args>(args)...);
+}
+
+template<typename T, typename SizeType>
+template<typename InputIterator, typename>
+void ProfiledVector<T, SizeType>::assign(InputIterator first, InputIterator last)
+{
+	reserve_hint();
+	base_type::assign(first, last);
+}
+
+template<typename T, typename SizeType>
+void ProfiledVector<T, SizeType>::assign(const std::size_t count, const T& value)
+{
+	reserve_hint(count);
+	base_type::assign(count, value);
+}
+
+template<typename T, typename SizeType>
+template<typename InputIterator, typename>
+void ProfiledVector<T, SizeType>::append(InputIterator first, InputIterator last)
+{
+	reserve_hint();
+	base_type::append(first, last);
+}
+
+template<typename T, typename SizeType>
+template<typename Range>
+void ProfiledVector<T, SizeType>::append(const Range& range)
+{
+	reserve_hint();
+	base_type::append(range);
+}
+
+template<typename T, typename SizeType>
+template<typename Generator>
+void ProfiledVector<T, SizeType>::generate_back(const std::size_t count, Generator generator)
+{
+	reserve_hint(count);
+	base_type::generate_back(count, std::move(generator));
+}
+
+template<typename T, typename SizeType>
+void ProfiledVector<T, SizeType>::reserve(const std::size_t newCapacity)
+{
+	reserve_hint(newCapacity);
+	base_type::reserve(newCapacity);
+}
+
+template<typename T, typename SizeType>
+void ProfiledVector<T, SizeType>::clear() noexcept
+{
+	_peakSize = std::max(_peakSize, base_type::size());
+
+	base_type::clear();
+}
+
+template<typename T, typename SizeType>
+inline const typename ProfiledVector<T, SizeType>::base_type&
+ProfiledVector<T, SizeType>::vector() const noexcept
+{
+	return *this;
+}
+
+template<typename T, typename SizeType>
+inline const char* ProfiledVector<T, SizeType>::key() const noexcept
+{
+	return _site->key();
+}
+
+// The learned capacity is only reserved once the Vector needs storage, so a
+// ProfiledVector that stays empty allocates nothing. A larger request than
+// the hint is reserved in one step.
+template<typename T, typename SizeType>
+inline void ProfiledVector<T, SizeType>::reserve_hint(const std::size_t needed)
+{
+	if (VECTOR_UNLIKELY(base_type::capacity() == 0))
+	{
+		const std::size_t learnedCapacity = _site->hint();
+
+		if (learnedCapacity > 0)
+		{
+			_initialCapacity = static_cast<size_type>(std::min<std::size_t>(learnedCapacity, base_type::max_size()));
+			base_type::reserve(std::max<std::size_t>(_initialCapacity, needed));
+		}
+	}
+}
@@ -0,0 +1,325 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include "Vector.h"
+#include "VectorParallel.h"
+
+///////////////////////////////////////////////////////////////////////////////
+/// radix_key_traits
+///
+/// Maps a sort key to an unsigned integer of the same width whose unsigned
+/// order matches the key's order, so that an LSD radix sort can work on raw
+/// bytes. Supported for integers (other than bool) and IEEE float/double;
+/// NaNs sort after +inf, or before -inf when their sign bit is set.
+///
+template<typename Key, typename = void>
+struct radix_key_traits
+{
+	static constexpr bool kSupported = false;
+};
+
+template<typename Key>
+struct radix_key_traits<Key, std::enable_if_t<std::is_integral_v<Key> && !std::is_same_v<Key, bool>>>
+{
+	static constexpr bool kSupported = true;
+
+	typedef std::make_unsigned_t<Key> bits_type;
+
+	static bits_type to_bits(Key key) noexcept
+	{
+		constexpr bits_type signBit = std::is_signed_v<Key> ? bits_type(bits_type(1) << (sizeof(Key) * 8 - 1)) : bits_type(0);
+
+		return static_cast<bits_type>(static_cast<bits_type>(key) ^ signBit);
+	}
+};
+
+template<typename Key>
+struct radix_key_traits<Key, std::enable_if_t<std::is_floating_point_v<Key> && (sizeof(Key) == 4 || sizeof(Key) == 8)>>
+{
+	static constexpr bool kSupported = std::numeric_limits<Key>::is_iec559;
+
+	typedef std::conditional_t<sizeof(Key) == 4, std::uint32_t, std::uint64_t> bits_type;
+
+	static bits_type to_bits(Key key) noexcept
+	{
+		constexpr bits_type signBit = bits_type(1) << (sizeof(Key) * 8 - 1);
+
+		bits_type bits;
+		std::memcpy(&bits, &key, sizeof(bits));
+
+		// Negative values count down from the sign bit, positive ones up from it.
+		return (bits & signBit) ? bits_type(~bits) : bits_type(bits | signBit);
+	}
+};
+
+///////////////////////////////////////////////////////////////////////////////
+/// VectorSort
+///
+/// The two sorts behind parallel_sort() and parallel_sort_by_key(), both
+/// stable:
+///
+/// radix_sort  - stable LSD radix sort, one pass per key byte, for trivially
+///               copyable elements with integer or floating point keys. The
+///               ping-pong buffer is the Vector's own spare capacity when it
+///               holds at least size() elements, a temporary buffer otherwise.
+///               Passes in which every key has the same byte are skipped.
+/// merge_sort  - for everything else: std::stable_sort on one slice per
+///               thread, then rounds of pairwise std::inplace_merge, which
+///               keeps equal elements of the left slice first.
+///
+/// Both cut the input into one slice per thread of VectorThreadPool, with at
+/// least kMinimumElementsPerThread elements each, and run the slices on that
+/// pool, so sorts share one thread budget with the parallel algorithms and
+/// start no threads of their own. Small inputs stay on the calling thread.
+///
+class VectorSort
+{
+public:
+	static constexpr std::size_t kMinimumElementsPerThread = 1 << 16;
+
+	/// The number of slices a sort of elementCount elements is cut into.
+	static std::size_t thread_count(std::size_t elementCount)
+	{
+		const std::size_t maximumThreads = VectorThreadPool::instance().thread_count();
+
+		return std::max<std::size_t>(1, std::min(maximumThreads, elementCount / kMinimumElementsPerThread));
+	}
+
+	template<typename T, typename SizeType, typename KeyFunction>
+	static void radix_sort(Vector<T, SizeType>& vector, KeyFunction key)
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "radix_sort moves elements with plain copies");
+
+		const std::size_t count = vector.size();
+
+		if (count < 2)
+		{
+			return;
+		}
+
+		T* scratch = nullptr;
+		const bool useSpareCapacity = vector.capacity() - vector.size() >= vector.size();
+
+		if (useSpareCapacity)
+		{
+			scratch = vector.data() + count;
+		}
+		else
+		{
+			scratch = Vector<T, SizeType>::allocate_buffer(static_cast<SizeType>(count));
+		}
+
+		// The passes run on the pool and allocate, so a temporary scratch buffer is
+		// freed on the way out either way.
+		VECTOR_TRY
+		{
+			T* sorted = radix_passes(vector.data(), scratch, count, key);
+
+			if (sorted != vector.data())
+			{
+				std::memcpy(static_cast<void*>(vector.data()), sorted, count * sizeof(T));
+			}
+		}
+		VECTOR_CATCH_ALL
+		{
+			if (!useSpareCapacity)
+			{
+				Vector<T, SizeType>::deallocate_buffer(scratch, static_cast<SizeType>(count));
+			}
+
+			VECTOR_RETHROW;
+		}
+
+		if (!useSpareCapacity)
+		{
+			Vector<T, SizeType>::deallocate_buffer(scratch, static_cast<SizeType>(count));
+		}
+	}
+
+	template<typename Iterator, typename Compare>
+	static void merge_sort(Iterator first, Iterator last, Compare compare)
+	{
+		const std::size_t count = static_cast<std::size_t>(last - first);
+		const std::size_t slices = thread_count(count);
+
+		if (slices == 1)
+		{
+			std::stable_sort(first, last, compare);
+			return;
+		}
+
+		auto boundary = [first, count, slices](std::size_t slice)
+		{
+			return first + static_cast<std::ptrdiff_t>(std::min(count, slice * ((count + slices - 1) / slices)));
+		};
+
+		run_parallel(slices, [&](std::size_t slice)
+		{
+			std::stable_sort(boundary(slice), boundary(slice + 1), compare);
+		});
+
+		for (std::size_t width = 1; width < slices; width *= 2)
+		{
+			const std::size_t merges = (slices + 2 * width - 1) / (2 * width);
+
+			run_parallel(merges, [&](std::size_t merge)
+			{
+				const std::size_t left = merge * 2 * width;
+
+				if (left + width < slices)
+				{
+					std::inplace_merge(boundary(left), boundary(left + width), boundary(std::min(slices, left + 2 * width)), compare);
+				}
+			});
+		}
+	}
+
+private:
+	// Runs task(i) for i in [0, taskCount) on the pool, each index a piece of
+	// its own, and rethrows the first exception once the loop is over.
+	template<typename Task>
+	static void run_parallel(std::size_t taskCount, Task&& task)
+	{
+		VectorThreadPool::instance().parallel_for(taskCount, 1, [&task](std::size_t begin, std::size_t end)
+		{
+			for (std::size_t i = begin; i < end; ++i)
+			{
+				task(i);
+			}
+		});
+	}
+
+	// Sorts by one byte of the key per pass, alternating between the two
+	// buffers, and returns the buffer that holds the result. Every pass builds
+	// one histogram per thread slice, so each thread then scatters its slice
+	// to precomputed, disjoint destination ranges.
+	template<typename T, typename KeyFunction>
+	static T* radix_passes(T* source, T* destination, std::size_t count, KeyFunction key)
+	{
+		typedef std::decay_t<std::invoke_result_t<KeyFunction, const T&>> key_type;
+		typedef radix_key_traits<key_type> traits;
+		typedef std::array<std::size_t, 256> histogram;
+
+		const std::size_t slices = thread_count(count);
+		const std::size_t sliceSize = (count + slices - 1) / slices;
+		Vector<histogram> offsets(slices);
+
+		for (std::size_t byte = 0; byte < sizeof(typename traits::bits_type); ++byte)
+		{
+			const unsigned shift = static_cast<unsigned>(byte * 8);
+
+			auto digit = [&key, shift](const T& element)
+			{
+				return static_cast<std::size_t>((traits::to_bits(key(element)) >> shift) & 0xff);
+			};
+
+			run_parallel(slices, [&](std::size_t slice)
+			{
+				histogram& counts = offsets[slice];
+				counts.fill(0);
+
+				for (std::size_t i = slice * sliceSize, end = std::min(count, i + sliceSize); i < end; ++i)
+				{
+					counts[digit(source[i])] += 1;
+				}
+			});
+
+			bool skipPass = false;
+			std::size_t running = 0;
+
+			for (std::size_t value = 0; value < 256; ++value)
+			{
+				std::size_t valueCount = 0;
+
+				for (std::size_t slice = 0; slice < slices; ++slice)
+				{
+					const std::size_t sliceCount = offsets[slice][value];
+					offsets[slice][value] = running;
+					running += sliceCount;
+					valueCount += sliceCount;
+				}
+
+				skipPass = skipPass || valueCount == count;
+			}
+
+			if (skipPass)
+			{
+				continue;
+			}
+
+			run_parallel(slices, [&](std::size_t slice)
+			{
+				histogram& next = offsets[slice];
+
+				for (std::size_t i = slice * sliceSize, end = std::min(count, i + sliceSize); i < end; ++i)
+				{
+					destination[next[digit(source[i])]++] = source[i];
+				}
+			});
+
+			std::swap(source, destination);
+		}
+
+		return source;
+	}
+};
+
+///////////////////////////////////////////////////////////////////////////////
+/// parallel_sort
+///
+/// Sorts a Vector ascending, keeping equal elements in their original order.
+/// Integers and floats go through the parallel radix sort; any other element
+/// type through the parallel merge sort with operator<, or with the given
+/// comparison.
+///
+template<typename T, typename SizeType>
+void parallel_sort(Vector<T, SizeType>& vector)
+{
+	if constexpr (radix_key_traits<T>::kSupported)
+	{
+		VectorSort::radix_sort(vector, [](const T& element) { return element; });
+	}
+	else
+	{
+		VectorSort::merge_sort(vector.begin(), vector.end(), std::less<T>());
+	}
+}
+
+template<typename T, typename SizeType, typename Compare>
+void parallel_sort(Vector<T, SizeType>& vector, Compare compare)
+{
+	VectorSort::merge_sort(vector.begin(), vector.end(), compare);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// parallel_sort_by_key
+///
+/// Sorts a Vector ascending by key(element), e.g. a struct by one of its
+/// fields, keeping elements with equal keys in their original order.
+/// Trivially copyable elements with an integer or float key are radix sorted;
+/// anything else is merge sorted on the key.
+///
+template<typename T, typename SizeType, typename KeyFunction>
+void parallel_sort_by_key(Vector<T, SizeType>& vector, KeyFunction key)
+{
+	typedef std::decay_t<std::invoke_result_t<KeyFunction, const T&>> key_type;
+
+	if constexpr (std::is_trivially_copyable_v<T> && radix_key_traits<key_type>::kSupported)
+	{
+		VectorSort::radix_sort(vector, key);
+	}
+	else
+	{
+		VectorSort::merge_sort(vector.begin(), vector.end(), [&key](const T& a, const T& b)
+		{
+			return key(a) < key(b);
+		});
+	}
+}